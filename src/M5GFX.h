@@ -25,6 +25,8 @@
 #include "lgfx/v1/lgfx_filesystem_support.hpp"
 #include "lgfx/v1/LGFXBase.hpp"
 #include "lgfx/v1/LGFX_Sprite.hpp"
+#include "lgfx/v1/LGFX_DisplayList.hpp"
+#include "lgfx/v1/LGFX_Compositor.hpp"
 
 #include <vector>
 
@@ -128,6 +128,10 @@ struct _pngle_t {
   pngle_init_callback_t init_callback;
   pngle_draw_callback_t draw_callback;
   pngle_done_callback_t done_callback;
+  pngle_row_callback_t row_callback;
+
+  // row output buffer for row_callback (width * RGBA)
+  uint8_t *row_buf;
 
   void *user_data;
 };
@@ -171,6 +175,7 @@ void lgfx_pngle_reset(pngle_t *pngle)
   pngle->error = "No error";
 
   if (pngle->scanline_ringbuf) { free(pngle->scanline_ringbuf); pngle->scanline_ringbuf = NULL; }
+  if (pngle->row_buf         ) { free(pngle->row_buf         ); pngle->row_buf = NULL; }
   if (pngle->palette         ) { free(pngle->palette         ); pngle->palette = NULL;}
   if (pngle->trans_palette   ) { free(pngle->trans_palette   ); pngle->trans_palette = NULL; }
 
@@ -257,7 +262,13 @@ static int pngle_draw_pixels(pngle_t *pngle, size_t scanline_ringbuf_xidx, uint_
 {
   uint_fast8_t n_pixels = pngle->n_pixels;
 
-  if (pngle->draw_callback) {
+  uint8_t *row = NULL;
+  if (pngle->row_callback && pngle->interlace_pass == 0) {
+    if (!pngle->row_buf && (pngle->row_buf = PNGLE_CALLOC(pngle->hdr.width, 4, "row buf")) == NULL) return PNGLE_ERROR("Insufficient memory");
+    row = pngle->row_buf;
+  }
+
+  if (pngle->draw_callback || row) {
     uint_fast8_t bitcount = 0;
 
     do {
@@ -320,26 +331,32 @@ static int pngle_draw_pixels(pngle_t *pngle, size_t scanline_ringbuf_xidx, uint_
         v[1] = v[2] = v[0];
       }
 
+      uint8_t *px = row ? &row[pngle->drawing_x << 2] : rgba;
       if (v[3]) { // transparent check
         uint_fast8_t pixel_depth = pngle->pixel_depth;
         uint_fast16_t magni = pngle->magni;
-        rgba[0] = ((v[0] * magni) >> pixel_depth);
-        rgba[1] = ((v[1] * magni) >> pixel_depth);
-        rgba[2] = ((v[2] * magni) >> pixel_depth);
-        rgba[3] = ((v[3] * magni) >> pixel_depth);
+        px[0] = ((v[0] * magni) >> pixel_depth);
+        px[1] = ((v[1] * magni) >> pixel_depth);
+        px[2] = ((v[2] * magni) >> pixel_depth);
+        px[3] = ((v[3] * magni) >> pixel_depth);
 
 #ifndef PNGLE_NO_GAMMA_CORRECTION
         if (pngle->gamma_table) {
           for (int i = 0; i < 3; i++) {
-            rgba[i] = pngle->gamma_table[v[i]];
+            px[i] = pngle->gamma_table[v[i]];
           }
         }
 #endif
-        pngle->draw_callback(pngle, pngle->drawing_x, pngle->drawing_y, rgba);
+        if (!row) pngle->draw_callback(pngle, pngle->drawing_x, pngle->drawing_y, px);
+      } else if (row) {
+        memset(px, 0, 4);
       }
       pngle->drawing_x += interlace_div_x[pngle->interlace_pass];
     } while (--n_pixels && pngle->drawing_x < pngle->hdr.width);
 
+    if (row && pngle->drawing_x >= pngle->hdr.width) {
+      pngle->row_callback(pngle, pngle->drawing_y, row, pngle->hdr.width);
+    }
     return 0;
   }
 
@@ -868,6 +885,12 @@ void lgfx_pngle_set_done_callback(pngle_t *pngle, pngle_done_callback_t callback
   pngle->done_callback = callback;
 }
 
+void lgfx_pngle_set_row_callback(pngle_t *pngle, pngle_row_callback_t callback)
+{
+  if (!pngle) return ;
+  pngle->row_callback = callback;
+}
+
 void lgfx_pngle_set_user_data(pngle_t *pngle, void *user_data)
 {
   if (!pngle) return ;
@@ -47,6 +47,9 @@ typedef struct _pngle_t pngle_t;
 typedef void (*pngle_init_callback_t)(pngle_t *pngle, uint32_t w, uint32_t h, uint_fast8_t hasTransparent);
 typedef void (*pngle_draw_callback_t)(pngle_t *pngle, uint32_t x, uint32_t y, uint8_t rgba[4]);
 typedef void (*pngle_done_callback_t)(pngle_t *pngle);
+// Called once per decoded row with w pixels of RGBA (4 bytes each, fully transparent pixels are all zero).
+// Only non-interlaced images are delivered by row; interlaced images still go through the draw callback.
+typedef void (*pngle_row_callback_t)(pngle_t *pngle, uint32_t y, uint8_t *rgba, uint32_t w);
 
 // ----------------
 // Basic interfaces
@@ -63,6 +66,7 @@ uint32_t lgfx_pngle_get_height(pngle_t *pngle);
 void lgfx_pngle_set_init_callback(pngle_t *png, pngle_init_callback_t callback);
 void lgfx_pngle_set_draw_callback(pngle_t *png, pngle_draw_callback_t callback);
 void lgfx_pngle_set_done_callback(pngle_t *png, pngle_done_callback_t callback);
+void lgfx_pngle_set_row_callback(pngle_t *png, pngle_row_callback_t callback);
 
 void lgfx_pngle_set_display_gamma(pngle_t *pngle, double display_gamma); // enables gamma correction by specifying display gamma, typically 2.2. No effect when gAMA chunk is missing
 
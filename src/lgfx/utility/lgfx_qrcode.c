@@ -866,6 +866,32 @@ int8_t lgfx_qrcode_initText(QRCode *qrcode, uint8_t *modules, uint8_t version, u
     return lgfx_qrcode_initBytes(qrcode, modules, version, ecc, (uint8_t*)data, strlen(data));
 }
 
+uint8_t lgfx_qrcode_getMinVersion(uint8_t ecc, const uint8_t *data, uint16_t length) {
+    uint8_t eccFormatBits = (ECC_FORMAT_BITS >> (2 * ecc)) & 0x03;
+
+    // Payload bits of the mode chosen by encodeDataCodewords (without the character count)
+    uint8_t mode = MODE_BYTE;
+    uint32_t bits = (uint32_t)length * 8;
+    if (isNumeric((const char*)data, length)) {
+        mode = MODE_NUMERIC;
+        bits = (length / 3) * 10 + ((length % 3) ? (length % 3) * 3 + 1 : 0);
+    } else if (isAlphanumeric((const char*)data, length)) {
+        mode = MODE_ALPHANUMERIC;
+        bits = (length >> 1) * 11 + (length & 1) * 6;
+    }
+
+#if LOCK_VERSION == 0
+    for (uint8_t version = 1; version <= 40; ++version) {
+        uint16_t dataCapacity = (NUM_RAW_DATA_MODULES[version - 1] >> 3) - NUM_ERROR_CORRECTION_CODEWORDS[eccFormatBits][version - 1];
+        if (4 + getModeBits(version, mode) + bits <= (uint32_t)dataCapacity * 8) { return version; }
+    }
+#else
+    uint16_t dataCapacity = (NUM_RAW_DATA_MODULES >> 3) - NUM_ERROR_CORRECTION_CODEWORDS[eccFormatBits];
+    if (4 + getModeBits(LOCK_VERSION, mode) + bits <= (uint32_t)dataCapacity * 8) { return LOCK_VERSION; }
+#endif
+    return 0;
+}
+
 bool lgfx_qrcode_getModule(QRCode *qrcode, uint_fast8_t x, uint_fast8_t y) {
     if (x >= qrcode->size || y >= qrcode->size) {
         return false;
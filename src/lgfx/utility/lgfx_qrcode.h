@@ -88,6 +88,9 @@ uint16_t lgfx_qrcode_getBufferSize(uint8_t version);
 int8_t lgfx_qrcode_initText(QRCode *qrcode, uint8_t *modules, uint8_t version, uint8_t ecc, const char *data);
 int8_t lgfx_qrcode_initBytes(QRCode *qrcode, uint8_t *modules, uint8_t version, uint8_t ecc, uint8_t *data, uint16_t length);
 
+// Smallest version that holds the data (0: too long)
+uint8_t lgfx_qrcode_getMinVersion(uint8_t ecc, const uint8_t *data, uint16_t length);
+
 bool lgfx_qrcode_getModule(QRCode *qrcode, uint_fast8_t x, uint_fast8_t y);
 
 
@@ -193,48 +193,71 @@ static int32_t create_qt_tbl (	/* 0:OK, !0:Failed */
 /* Create huffman code tables with a DHT segment                         */
 /*-----------------------------------------------------------------------*/
 
-static int32_t create_huffman_tbl (	/* 0:OK, !0:Failed */
+static int32_t set_huffman_tbl (	/* 0:OK, !0:Failed */
 	lgfxJdec* jd,					/* Pointer to the decompressor object */
-	const uint8_t* data,		/* Pointer to the packed huffman tables */
-	int_fast16_t ndata				/* Size of input data */
+	uint_fast8_t d,					/* Table class and number */
+	const uint8_t* bits				/* Number of code words for 1 to 16-bit code */
 )
 {
 	uint_fast16_t np;
 	uint8_t *pb, *pd;
 	uint16_t *ph;
 
-	do {	/* Process all tables in the segment */
-		uint_fast8_t d = *data++;			/* Get table number and class */
-		if (d & 0xEE) return JDR_FMT1;		/* Err: invalid class/number */
-		uint_fast8_t cls = d >> 4;			/* class = dc(0)/ac(1), table number = 0/1 */
-		uint_fast8_t num = d & 0x0F;
+	if (d & 0xEE) return JDR_FMT1;		/* Err: invalid class/number */
+	uint_fast8_t cls = d >> 4;			/* class = dc(0)/ac(1), table number = 0/1 */
+	uint_fast8_t num = d & 0x0F;
+	np = 0;
+	size_t i = 0;
+	do {								/* Get sum of code words for each code */
+		np += bits[i];
+	} while (++i < 16);
+
+	if (jd->huffbits[num][cls] && jd->huffcap[num][cls] >= np) {	/* Reuse the table (progressive JPEG redefines tables for each scan) */
+		pb = jd->huffbits[num][cls] + 1;
+		ph = jd->huffcode[num][cls] + 1;
+		pd = jd->huffdata[num][cls] + 1;
+	} else {
 		pb = alloc_pool(jd, 16);			/* Allocate a memory block for the bit distribution table */
-		if (!pb) return JDR_MEM1;			/* Err: not enough memory */
-		jd->huffbits[num][cls] = pb - 1;
-		np = 0;
-		size_t i = 0;
-		do {								/* Load number of patterns for 1 to 16-bit code */
-			np += (pb[i] = data[i]);		/* Get sum of code words for each code */
-		} while (++i < 16);
-
 		ph = (uint16_t*)alloc_pool(jd, np * sizeof (uint16_t));/* Allocate a memory block for the code word table */
-		if (!ph) return JDR_MEM1;			/* Err: not enough memory */
-		jd->huffcode[num][cls] = ph - 1;
-		uint_fast16_t hc = 0;
-		i = 0;
-		do {								/* Re-build huffman code word table */
-			size_t b = pb[i];
-			while (b--) *ph++ = hc++;
-			hc <<= 1;
-		} while (++i < 16);
-
 		pd = alloc_pool(jd, np);			/* Allocate a memory block for the decoded data */
-		if (!pd) return JDR_MEM1;			/* Err: not enough memory */
+		if (!pb || !ph || !pd) return JDR_MEM1;	/* Err: not enough memory */
+		jd->huffbits[num][cls] = pb - 1;
+		jd->huffcode[num][cls] = ph - 1;
 		jd->huffdata[num][cls] = pd - 1;
+		jd->huffcap[num][cls] = np;
+	}
+	memcpy(pb, bits, 16);
+
+	uint_fast16_t hc = 0;
+	i = 0;
+	do {								/* Re-build huffman code word table */
+		size_t b = pb[i];
+		while (b--) *ph++ = hc++;
+		hc <<= 1;
+	} while (++i < 16);
+
+	return JDR_OK;
+}
+
+
+static int32_t create_huffman_tbl (	/* 0:OK, !0:Failed */
+	lgfxJdec* jd,					/* Pointer to the decompressor object */
+	const uint8_t* data,		/* Pointer to the packed huffman tables */
+	int_fast16_t ndata				/* Size of input data */
+)
+{
+	do {	/* Process all tables in the segment */
+		uint_fast8_t d = *data++;			/* Get table number and class */
+		uint_fast16_t np = 0;
+		for (size_t i = 0; i < 16; ++i) np += data[i];
+		if (ndata < (int_fast16_t)(17 + np)) return JDR_FMT1;
+		int32_t rc = set_huffman_tbl(jd, d, data);
+		if (rc) return rc;
 
-		memcpy(pd, data += 16, np);			/* Load decoded data corresponds to each code ward */
+		memcpy(jd->huffdata[d & 0x0F][d >> 4] + 1, data += 16, np);	/* Load decoded data corresponds to each code ward */
 		data += np;
-	} while (ndata -= 17 + np);
+		ndata -= 17 + np;
+	} while (ndata > 0);
 
 	return JDR_OK;
 }
@@ -503,7 +526,8 @@ static void block_idct (
 /*-----------------------------------------------------------------------*/
 
 static JRESULT mcu_load (
-	lgfxJdec* jd		/* Pointer to the decompressor object */
+	lgfxJdec* jd,		/* Pointer to the decompressor object */
+	uint_fast8_t idct	/* 0:Only advance the bit stream (the MCU is not output) */
 )
 {
 	int32_t *tmp = (int32_t*)jd->workbuf;	/* Block working buffer for de-quantize and IDCT */
@@ -538,14 +562,29 @@ static JRESULT mcu_load (
 			jd->dcv[cmp] = d;					/* Save current DC value for next block */
 		}
 		const int32_t *dqf = jd->qttbl[jd->qtid[cmp]];			/* De-quantizer table ID for this component */
-		tmp[0] = d * dqf[0] >> 8;				/* De-quantize, apply scale factor of Arai algorithm and descale 8 bits */
-
-		/* Extract following 63 AC elements from input stream */
-		memset(&tmp[1], 0, 63*sizeof(int32_t));	/* Clear rest of elements */
 		hb = jd->huffbits[id][1];				/* Huffman table for the AC elements */
 		hc = jd->huffcode[id][1];
 		hd = jd->huffdata[id][1];
 		uint_fast8_t i = 1;					/* Top of the AC elements */
+
+		if (!idct) {	/* Invisible MCU: extract AC elements only to advance the stream */
+			do {
+				b = huffext(jd, hb, hc, hd);
+				if (b == 0) break;
+				if (b < 0) return (JRESULT)(-b);
+				i += b >> 4;
+				if (b &= 0x0F) {
+					d = bitext(jd, b);
+					if (d < 0) return (JRESULT)(-d);
+				}
+			} while (++i < 64);
+			continue;
+		}
+
+		tmp[0] = d * dqf[0] >> 8;				/* De-quantize, apply scale factor of Arai algorithm and descale 8 bits */
+
+		/* Extract following 63 AC elements from input stream */
+		memset(&tmp[1], 0, 63*sizeof(int32_t));	/* Clear rest of elements */
 		do {
 			b = huffext(jd, hb, hc, hd);		/* Extract a huffman coded value (zero runs and bit length) */
 			if (b == 0) break;					/* EOB? */
@@ -592,6 +631,11 @@ static JRESULT mcu_output (
 	int32_t yy, cb, cr;
 	uint8_t *py, *pc, *rgb24;
 	JRECT rect;
+	uint_fast8_t format = jd->format;
+	uint_fast8_t direct = format && !(JD_USE_SCALE && jd->scale);	/* RGB565 is built directly without RGB888 stage */
+#if JD_BAYER
+	int_fast8_t bmask = jd->dither ? ~0 : 0;
+#endif
 
 	mx = jd->msx << 3; my = jd->msy << 3;					/* MCU size (pixel) */
 	rx = (mx < jd->width - x) ? mx : jd->width - x;	/* Output rectangular size (it may be clipped at right/bottom end) */
@@ -635,16 +679,25 @@ static JRESULT mcu_output (
 					uint_fast16_t bb = ((int32_t)(1.772   * (1<<FP_SHIFT)) * cb) >> FP_SHIFT;
 					do {
 #if JD_BAYER
-						yy = *py + btbl[ix & 3];		/* Get Y component */
+						yy = *py + (btbl[ix & 3] & bmask);	/* Get Y component */
 #else
 						yy = *py;					/* Get Y component */
 #endif
 						++py;
 					/* Convert YCbCr to RGB */
-						rgb24[0] = BYTECLIP(yy + rr);
-						rgb24[1] = BYTECLIP(yy - gg);
-						rgb24[2] = BYTECLIP(yy + bb);
-						rgb24 += 3;
+						if (direct) {
+							uint_fast16_t w = (BYTECLIP(yy + rr) & 0xF8) << 8
+							                | (BYTECLIP(yy - gg) & 0xFC) << 3
+							                |  BYTECLIP(yy + bb) >> 3;
+							if (format == 2) { rgb24[0] = w >> 8; rgb24[1] = w; }
+							else             { rgb24[0] = w; rgb24[1] = w >> 8; }
+							rgb24 += 2;
+						} else {
+							rgb24[0] = BYTECLIP(yy + rr);
+							rgb24[1] = BYTECLIP(yy - gg);
+							rgb24[2] = BYTECLIP(yy + bb);
+							rgb24 += 3;
+						}
 					} while (++ix & ixshift);
 				} while (ix & 7);
 				py += 64 - 8;	/* Jump to next block if double block heigt */
@@ -715,16 +768,17 @@ static JRESULT mcu_output (
 	mx >>= jd->scale;
 	if (rx < mx) {
 		uint8_t *s, *d;
+		uint_fast8_t bpp = direct ? 2 : 3;
 		s = d = workbuf;
 		for (size_t y = 1; y < ry; ++y) {
-			memcpy(d += rx * 3, s += mx * 3, rx * 3);	/* Copy effective pixels */
+			memmove(d += rx * bpp, s += mx * bpp, rx * bpp);	/* Copy effective pixels (regions may overlap) */
 		}
 	}
 
 	/* Convert RGB888 to RGB565 if needed */
-	if (JD_FORMAT == 1) {
+	if (format && !direct) {
 		uint8_t *s = workbuf;
-		uint16_t *d = (uint16_t*)s;
+		uint8_t *d = s;
 		uint_fast16_t w;
 		uint_fast16_t n = rx * ry;
 
@@ -732,7 +786,9 @@ static JRESULT mcu_output (
 			w = (*s++ & 0xF8) << 8;		/* RRRRR----------- */
 			w |= (*s++ & 0xFC) << 3;	/* -----GGGGGG----- */
 			w |= *s++ >> 3;				/* -----------BBBBB */
-			*d++ = w;
+			if (format == 2) { d[0] = w >> 8; d[1] = w; }
+			else             { d[0] = w; d[1] = w >> 8; }
+			d += 2;
 		} while (--n);
 	}
 
@@ -781,6 +837,561 @@ static JRESULT restart (
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Skip entropy coded data up to the n-th restart marker                 */
+/*-----------------------------------------------------------------------*/
+
+static JRESULT skip_restart (
+	lgfxJdec* jd,		/* Pointer to the decompressor object */
+	uint32_t n,			/* Number of RSTn markers to pass through */
+	uint16_t rstn		/* Expected sequense number of the last marker */
+)
+{
+	uint8_t *dp = jd->dptr, *dpend = jd->dpend;
+	uint_fast8_t ff = 0, d;
+
+	for (;;) {
+		if (++dp == dpend) {	/* No input data is available, re-fill input buffer */
+			dp = jd->inbuf;
+			jd->dpend = dpend = dp + jd->infunc(jd, dp, JD_SZBUF);
+			if (dp == dpend) return JDR_INP;
+		}
+		d = *dp;
+		if (ff && (d & 0xF8) == 0xD0) {	/* RSTn marker */
+			if (!--n) break;
+		}
+		ff = (d == 0xFF);
+	}
+	jd->dptr = dp; jd->dmsk = 0;
+
+	if ((d & 7) != (rstn & 7)) return JDR_FMT1;	/* Err: unexpected marker sequence (may be collapted data) */
+
+	/* Reset DC offset */
+	jd->dcv[2] = jd->dcv[1] = jd->dcv[0] = 0;
+
+	return JDR_OK;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Progressive JPEG: get a byte / skip bytes of the input stream         */
+/*-----------------------------------------------------------------------*/
+
+static int32_t get_byte (	/* >=0: a byte, <0: end of stream */
+	lgfxJdec* jd		/* Pointer to the decompressor object */
+)
+{
+	uint8_t *dp = jd->dptr;
+
+	if (++dp == jd->dpend) {	/* No input data is available, re-fill input buffer */
+		dp = jd->inbuf;
+		jd->dpend = dp + jd->infunc(jd, dp, JD_SZBUF);
+		if (dp == jd->dpend) return -1;
+	}
+	jd->dptr = dp; jd->dmsk = 0;
+	return *dp;
+}
+
+
+static JRESULT skip_bytes (
+	lgfxJdec* jd,		/* Pointer to the decompressor object */
+	uint32_t len		/* Number of bytes to skip */
+)
+{
+	uint32_t remain = jd->dpend - jd->dptr - 1;	/* Bytes left in the input buffer */
+
+	if (len <= remain) {
+		jd->dptr += len;
+	} else {
+		jd->dptr = jd->dpend - 1;		/* Input buffer is empty */
+		len -= remain;
+		if (jd->infunc(jd, 0, len) != len) return JDR_INP;	/* Null pointer specifies to skip bytes of stream */
+	}
+	jd->dmsk = 0;
+	return JDR_OK;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Progressive JPEG: load scan parameters with an SOS segment            */
+/*-----------------------------------------------------------------------*/
+
+static JRESULT set_scan (
+	lgfxJdec* jd,		/* Pointer to the decompressor object */
+	const uint8_t* seg,	/* SOS segment data */
+	uint_fast16_t len	/* Size of segment data */
+)
+{
+	uint_fast8_t n = seg[0];
+
+	if (n < 1 || n > jd->comps_in_frame || len < 4 + n * 2u) return JDR_FMT1;
+	jd->scan_nc = n;
+	for (size_t i = 0; i < n; ++i) {
+		size_t c = 0;
+		while (jd->comp_id[c] != seg[1 + i * 2]) {	/* Find the component in the frame */
+			if (++c == jd->comps_in_frame) return JDR_FMT1;	/* Err: unknown component */
+		}
+		uint_fast8_t t = seg[2 + i * 2];
+		if (t & 0xEE) return JDR_FMT3;			/* Err: supports only huffman table 0 and 1 */
+		jd->scan_cmp[i] = c;
+		jd->scan_tbl[i] = t;
+	}
+	seg += 1 + n * 2;
+	jd->ss = seg[0]; jd->se = seg[1];			/* Spectral selection */
+	jd->ah = seg[2] >> 4; jd->al = seg[2] & 15;	/* Successive approximation */
+	if (jd->ss > jd->se || jd->se > 63 || (!jd->ss && jd->se) || (jd->ss && n != 1) || jd->al > 13) {
+		return JDR_FMT1;						/* Err: invalid scan parameters */
+	}
+
+	/* Check if the huffman tables for this scan have been loaded (DC refinement uses no table) */
+	for (size_t i = 0; i < n; ++i) {
+		uint_fast8_t t = jd->scan_tbl[i];
+		if (jd->ss ? !jd->huffbits[t & 15][1] : (!jd->ah && !jd->huffbits[t >> 4][0])) {
+			return JDR_FMT1;					/* Err: not loaded */
+		}
+	}
+	return JDR_OK;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Progressive JPEG: decode a block in current scan                      */
+/*-----------------------------------------------------------------------*/
+
+static JRESULT prog_block (
+	lgfxJdec* jd,		/* Pointer to the decompressor object */
+	int16_t* p,			/* Coefficients of the block (raster order) */
+	uint_fast8_t sc,	/* Component index in the scan */
+	uint32_t* eobrun	/* Remaining EOB run */
+)
+{
+	int32_t b, e;
+	uint_fast8_t t = jd->scan_tbl[sc];
+
+	if (!jd->ss) {		/* DC scan */
+		if (jd->ah) {	/* Refinement: a bit */
+			e = bitext(jd, 1);
+			if (e < 0) return (JRESULT)(-e);
+			if (e) p[0] |= 1 << jd->al;
+			return JDR_OK;
+		}
+		t >>= 4;
+		b = huffext(jd, jd->huffbits[t][0], jd->huffcode[t][0], jd->huffdata[t][0]);
+		if (b < 0) return (JRESULT)(-b);
+		uint_fast8_t c = jd->scan_cmp[sc];
+		if (b) {
+			e = bitext(jd, b);
+			if (e < 0) return (JRESULT)(-e);
+			b = 1 << (b - 1);					/* MSB position */
+			if (!(e & b)) e -= (b << 1) - 1;	/* Restore sign if needed */
+			jd->dcv[c] += e;
+		}
+		p[0] = (int16_t)(jd->dcv[c] * (1 << jd->al));
+		return JDR_OK;
+	}
+
+	t &= 15;
+	const uint8_t *hb = jd->huffbits[t][1], *hd = jd->huffdata[t][1];
+	const uint16_t *hc = jd->huffcode[t][1];
+	uint_fast8_t k = jd->ss, se = jd->se;
+
+	if (!jd->ah) {		/* AC first scan */
+		if (*eobrun) { --*eobrun; return JDR_OK; }
+		do {
+			b = huffext(jd, hb, hc, hd);
+			if (b < 0) return (JRESULT)(-b);
+			uint_fast8_t r = b >> 4, s = b & 15;
+			if (!s) {
+				if (r < 15) {					/* EOBn */
+					*eobrun = (1 << r) - 1;
+					if (r) {
+						e = bitext(jd, r);
+						if (e < 0) return (JRESULT)(-e);
+						*eobrun += e;
+					}
+					break;
+				}
+				k += 16;						/* ZRL */
+			} else {
+				k += r;
+				if (k > 63) return JDR_FMT1;	/* Err: may be collapted data */
+				e = bitext(jd, s);
+				if (e < 0) return (JRESULT)(-e);
+				b = 1 << (s - 1);
+				if (!(e & b)) e -= (b << 1) - 1;
+				p[Zig[k++]] = (int16_t)(e * (1 << jd->al));
+			}
+		} while (k <= se);
+		return JDR_OK;
+	}
+
+	/* AC refinement scan: a correction bit for each non-zero coefficient, new coefficients are +-1 */
+	int_fast16_t p1 = 1 << jd->al;
+	if (!*eobrun) {
+		do {
+			b = huffext(jd, hb, hc, hd);
+			if (b < 0) return (JRESULT)(-b);
+			int_fast16_t r = b >> 4, s = b & 15;
+			if (!s) {
+				if (r < 15) {					/* EOBn: refine the rest of this block */
+					*eobrun = (1 << r);
+					if (r) {
+						e = bitext(jd, r);
+						if (e < 0) return (JRESULT)(-e);
+						*eobrun += e;
+					}
+					break;
+				}
+			} else {
+				if (s != 1) return JDR_FMT1;	/* Err: may be collapted data */
+				e = bitext(jd, 1);
+				if (e < 0) return (JRESULT)(-e);
+				s = e ? p1 : -p1;
+			}
+			while (k <= se) {					/* Skip r zero coefficients, refine non-zero ones on the way */
+				int16_t* q = &p[Zig[k++]];
+				if (*q) {
+					e = bitext(jd, 1);
+					if (e < 0) return (JRESULT)(-e);
+					if (e && !(*q & p1)) *q += (*q >= 0) ? p1 : -p1;
+				} else {
+					if (!r) { *q = (int16_t)s; break; }
+					--r;
+				}
+			}
+		} while (k <= se);
+		if (!*eobrun) return JDR_OK;
+	}
+	--*eobrun;							/* The block is in an EOB run */
+	for (; k <= se; ++k) {
+		int16_t* q = &p[Zig[k]];
+		if (*q) {
+			e = bitext(jd, 1);
+			if (e < 0) return (JRESULT)(-e);
+			if (e && !(*q & p1)) *q += (*q >= 0) ? p1 : -p1;
+		}
+	}
+	return JDR_OK;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Progressive JPEG: decode a scan into the band                         */
+/*-----------------------------------------------------------------------*/
+
+typedef struct {
+	int16_t* plane[3];		/* Coefficients of the band for each component */
+	uint8_t* nzmap[3];		/* Non-zero map of the whole image for each component (NULL:single band) */
+	uint32_t stride[3];		/* Blocks per row of each component */
+	uint32_t by0[3], by1[3];	/* Block rows of the band for each component */
+	uint32_t eobrun;		/* Remaining EOB run */
+	int16_t tmp[64];		/* Coefficients of a block out of the band */
+} prog_band_t;
+
+
+static JRESULT prog_unit (
+	lgfxJdec* jd,		/* Pointer to the decompressor object */
+	prog_band_t* band,	/* Band being decoded */
+	uint_fast8_t sc,	/* Component index in the scan */
+	uint32_t bx,		/* Block position in the component */
+	uint32_t by
+)
+{
+	uint_fast8_t c = jd->scan_cmp[sc];
+	uint32_t stride = band->stride[c];
+
+	if (by >= band->by0[c] && by < band->by1[c]) {	/* The block is in the band */
+		return prog_block(jd, &band->plane[c][((by - band->by0[c]) * stride + bx) << 6], sc, &band->eobrun);
+	}
+
+	/* Out of the band: only the stream is advanced, AC refinement needs to know which coefficients are non-zero */
+	int16_t* p = band->tmp;
+	uint8_t* m = &band->nzmap[c][(by * stride + bx) << 3];
+	if (!jd->ss) return prog_block(jd, p, sc, &band->eobrun);
+	for (size_t i = 0; i < 64; ++i) p[i] = (m[i >> 3] >> (i & 7)) & 1;
+	JRESULT rc = prog_block(jd, p, sc, &band->eobrun);
+	for (size_t i = 0; i < 64; ++i) if (p[i]) m[i >> 3] |= 1 << (i & 7);
+	return rc;
+}
+
+
+static JRESULT prog_scan (
+	lgfxJdec* jd,		/* Pointer to the decompressor object */
+	prog_band_t* band	/* Band being decoded */
+)
+{
+	uint32_t nrst = jd->nrst, rst = 0, rsc = 0;
+	JRESULT rc;
+
+	jd->dcv[2] = jd->dcv[1] = jd->dcv[0] = 0;	/* Initialize DC values */
+	band->eobrun = 0;
+
+	if (jd->scan_nc == 1) {	/* Non-interleaved scan: blocks in the component area, restart interval is in blocks */
+		uint_fast8_t c = jd->scan_cmp[0];
+		uint_fast8_t h = c ? 1 : jd->msx, v = c ? 1 : jd->msy;
+		uint32_t bw = ((jd->width  * h + jd->msx - 1) / jd->msx + 7) >> 3;
+		uint32_t bh = ((jd->height * v + jd->msy - 1) / jd->msy + 7) >> 3;
+		for (uint32_t by = 0; by < bh; ++by) {
+			for (uint32_t bx = 0; bx < bw; ++bx) {
+				if (nrst && rst++ == nrst) {
+					rc = restart(jd, rsc++);
+					if (rc != JDR_OK) return rc;
+					band->eobrun = 0;
+					rst = 1;
+				}
+				rc = prog_unit(jd, band, 0, bx, by);
+				if (rc != JDR_OK) return rc;
+			}
+		}
+		return JDR_OK;
+	}
+
+	/* Interleaved scan (DC only): blocks in MCU order */
+	uint32_t mx = jd->msx << 3, my = jd->msy << 3;
+	uint32_t cols = (jd->width  + mx - 1) / mx;
+	uint32_t rows = (jd->height + my - 1) / my;
+	for (uint32_t y = 0; y < rows; ++y) {
+		for (uint32_t x = 0; x < cols; ++x) {
+			if (nrst && rst++ == nrst) {
+				rc = restart(jd, rsc++);
+				if (rc != JDR_OK) return rc;
+				rst = 1;
+			}
+			for (uint_fast8_t sc = 0; sc < jd->scan_nc; ++sc) {
+				uint_fast8_t c = jd->scan_cmp[sc];
+				uint_fast8_t h = c ? 1 : jd->msx, v = c ? 1 : jd->msy;
+				for (uint_fast8_t iy = 0; iy < v; ++iy) {
+					for (uint_fast8_t ix = 0; ix < h; ++ix) {
+						rc = prog_unit(jd, band, sc, x * h + ix, y * v + iy);
+						if (rc != JDR_OK) return rc;
+					}
+				}
+			}
+		}
+	}
+	return JDR_OK;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Progressive JPEG: find the next scan                                  */
+/*-----------------------------------------------------------------------*/
+
+static int32_t next_scan (	/* 1:SOS is loaded, 0:end of image, <0: error code */
+	lgfxJdec* jd		/* Pointer to the decompressor object */
+)
+{
+	uint8_t seg[17];
+	int32_t d;
+
+	for (;;) {
+		do {	/* Find a marker (skip padding bits and fill bytes) */
+			d = get_byte(jd);
+			if (d < 0) return 0;	/* Truncated stream is shown as far as decoded */
+		} while (d != 0xFF);
+		do {
+			d = get_byte(jd);
+			if (d < 0) return 0;
+		} while (d == 0xFF);
+		if (d == 0 || (d >= 0xD0 && d <= 0xD8)) continue;	/* Stuffed byte, RSTn or SOI */
+		if (d == 0xD9) return 0;	/* EOI */
+
+		uint_fast8_t marker = d;
+		int32_t hi = get_byte(jd), lo = get_byte(jd);
+		if (hi < 0 || lo < 0) return 0;
+		int32_t len = (hi << 8 | lo) - 2;	/* Length field */
+		if (len < 0) return 0 - (int32_t)JDR_FMT1;
+
+		switch (marker) {
+		case 0xC4:	/* DHT: load tables directly from the stream */
+			while (len > 0) {
+				for (size_t i = 0; i < 17; ++i) {
+					if ((d = get_byte(jd)) < 0) return 0 - (int32_t)JDR_INP;
+					seg[i] = d;
+				}
+				d = set_huffman_tbl(jd, seg[0], &seg[1]);
+				if (d) return 0 - d;
+				uint8_t* pd = jd->huffdata[seg[0] & 15][seg[0] >> 4] + 1;
+				uint_fast16_t np = 0;
+				for (size_t i = 1; i < 17; ++i) np += seg[i];
+				len -= 17 + np;
+				while (np--) {
+					if ((d = get_byte(jd)) < 0) return 0 - (int32_t)JDR_INP;
+					*pd++ = d;
+				}
+			}
+			if (len) return 0 - (int32_t)JDR_FMT1;
+			break;
+
+		case 0xDD:	/* DRI */
+		case 0xDA:	/* SOS */
+			if (len > (int32_t)sizeof seg) return 0 - (int32_t)JDR_FMT1;
+			for (int32_t i = 0; i < len; ++i) {
+				if ((d = get_byte(jd)) < 0) return 0 - (int32_t)JDR_INP;
+				seg[i] = d;
+			}
+			if (marker == 0xDD) {
+				jd->nrst = seg[0] << 8 | seg[1];
+				break;
+			}
+			d = set_scan(jd, seg, len);
+			if (d) return 0 - d;
+			jd->dmsk = 0;	/* Prepare to read bit stream */
+			return 1;
+
+		default:	/* SOF, DQT (already loaded) and unknown segments */
+			d = skip_bytes(jd, len);
+			if (d) return 0 - d;
+		}
+	}
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Progressive JPEG: decompress and output the visible MCU rows          */
+/*-----------------------------------------------------------------------*/
+
+static JRESULT prog_decomp (
+	lgfxJdec* jd,								/* Initialized decompression object */
+	uint32_t (*outfunc)(lgfxJdec*, void*, JRECT*),	/* RGB output function */
+	uint32_t cx0, uint32_t cx1,					/* Visible MCU range */
+	uint32_t cy0, uint32_t cy1
+)
+{
+	prog_band_t band;
+	uint32_t mx, my, cols, rows, nrows, size, ystart, yend;
+	int32_t d;
+	JRESULT rc;
+
+
+	if (!jd->coef) return JDR_MEM1;
+	mx = jd->msx << 3; my = jd->msy << 3;
+	cols = (jd->width  + mx - 1) / mx;
+	rows = (jd->height + my - 1) / my;
+	nrows = jd->band_rows;
+	uint_fast8_t banded = (nrows && nrows < rows);
+	if (banded) {	/* Bands over the visible rows, blocks out of the band are tracked by the non-zero map */
+		if (!jd->nzmap) return JDR_PAR;
+		if (nrows <= cy1 - cy0 && !jd->seekfunc) return JDR_PAR;	/* Err: several passes need seeking */
+		ystart = cy0; yend = cy1 + 1;
+	} else {		/* A band of the whole image */
+		nrows = rows;
+		ystart = 0; yend = rows;
+	}
+
+	/* Layout of the coefficient buffer and the non-zero map */
+	int16_t* cp = jd->coef;
+	uint8_t* mp = jd->nzmap;
+	for (size_t c = 0; c < jd->comps_in_frame; ++c) {
+		uint_fast8_t h = c ? 1 : jd->msx, v = c ? 1 : jd->msy;
+		band.stride[c] = cols * h;
+		band.plane[c] = cp;
+		band.nzmap[c] = mp;
+		cp += (band.stride[c] * nrows * v) << 6;
+		if (banded) mp += (band.stride[c] * rows * v) << 3;
+	}
+	size = (cp - jd->coef) * sizeof (int16_t);
+
+	for (uint32_t y0 = ystart; y0 < yend; y0 += nrows) {
+		uint32_t y1 = (y0 + nrows < yend) ? y0 + nrows : yend;
+		for (size_t c = 0; c < jd->comps_in_frame; ++c) {
+			uint_fast8_t v = c ? 1 : jd->msy;
+			band.by0[c] = y0 * v;
+			band.by1[c] = y1 * v;
+		}
+		memset(jd->coef, 0, size);
+		if (banded) {
+			memset(jd->nzmap, 0, mp - jd->nzmap);
+		}
+
+		if (y0 != ystart) {	/* Rewind the stream for the next band */
+			if (!jd->seekfunc(jd, 2)) return JDR_INP;
+			jd->dpend = jd->inbuf;
+			jd->dptr = jd->inbuf - 1;
+			d = next_scan(jd);
+			if (d < 0) return (JRESULT)(-d);
+			if (!d) return JDR_FMT1;
+		}
+
+		do {	/* Decode all scans */
+			rc = prog_scan(jd, &band);
+			if (rc != JDR_OK) return rc;
+			d = next_scan(jd);
+			if (d < 0) return (JRESULT)(-d);
+		} while (d);
+
+		/* De-quantize, apply IDCT and output the MCUs of the band */
+		for (uint32_t y = (y0 > cy0) ? y0 : cy0; y < y1 && y <= cy1; ++y) {
+			for (uint32_t x = cx0; x <= cx1; ++x) {
+				int32_t *tmp = (int32_t*)jd->workbuf;
+				uint8_t *bp = jd->mcubuf;
+				for (size_t c = 0; c < jd->comps_in_frame; ++c) {
+					uint_fast8_t h = c ? 1 : jd->msx, v = c ? 1 : jd->msy;
+					const int32_t *dqf = jd->qttbl[jd->qtid[c]];
+					for (uint_fast8_t iy = 0; iy < v; ++iy) {
+						for (uint_fast8_t ix = 0; ix < h; ++ix) {
+							const int16_t* p = &band.plane[c][(((y - y0) * v + iy) * band.stride[c] + x * h + ix) << 6];
+							for (size_t i = 0; i < 64; ++i) tmp[i] = p[i] * dqf[i] >> 8;
+							if (JD_USE_SCALE && jd->scale == 3) {
+								*bp = (uint8_t)((*tmp >> 8) + 128);
+							} else {
+								block_idct(tmp, bp);
+							}
+							bp += 64;
+						}
+					}
+				}
+				rc = mcu_output(jd, outfunc, x * mx, y * my);
+				if (rc != JDR_OK) return rc;
+			}
+		}
+	}
+
+	return JDR_OK;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Progressive JPEG: size of the buffers provided by the caller          */
+/*-----------------------------------------------------------------------*/
+
+uint32_t lgfx_jd_coef_size (
+	lgfxJdec* jd,			/* Prepared decompression object */
+	uint_fast16_t nrows		/* MCU rows decoded per pass (0:all rows) */
+)
+{
+	uint32_t mx = jd->msx << 3, my = jd->msy << 3;
+	uint32_t cols = (jd->width  + mx - 1) / mx;
+	uint32_t rows = (jd->height + my - 1) / my;
+	if (!nrows || nrows > rows) nrows = rows;
+	return cols * nrows * (jd->msx * jd->msy + jd->comps_in_frame - 1) * 64 * sizeof (int16_t);
+}
+
+
+uint32_t lgfx_jd_nzmap_size (
+	lgfxJdec* jd			/* Prepared decompression object */
+)
+{
+	return lgfx_jd_coef_size(jd, 0) >> 4;	/* 64 bits for each block */
+}
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Analyze the JPEG image and Initialize decompressor object             */
 /*-----------------------------------------------------------------------*/
@@ -813,11 +1424,18 @@ JRESULT lgfx_jd_prepare (
 	jd->infunc = infunc;	/* Stream input function */
 	jd->device = dev;		/* I/O device identifier */
 	jd->nrst = 0;			/* No restart interval (default) */
-
-//	memset(jd->huffbits, 0, sizeof(uint8_t*) * 4);	/* Nulls pointers */
-//	memset(jd->huffcode, 0, sizeof(uint16_t*) * 4);
-//	memset(jd->huffdata, 0, sizeof(uint8_t*) * 4);
-//	memset(jd->qttbl, 0, sizeof(uint32_t*) * 4);
+	jd->format = JD_FORMAT;	/* Output pixel format (default) */
+	jd->dither = JD_BAYER;
+	jd->progressive = 0;
+	jd->coef = 0;			/* Coefficient buffer is given by the caller after prepare */
+	jd->nzmap = 0;
+	jd->band_rows = 0;
+	jd->seekfunc = 0;
+
+	memset(jd->huffbits, 0, sizeof jd->huffbits);	/* Nulls pointers (tables may be reused when redefined) */
+	memset(jd->huffcode, 0, sizeof jd->huffcode);
+	memset(jd->huffdata, 0, sizeof jd->huffdata);
+	memset(jd->qttbl, 0, sizeof jd->qttbl);
 
 	jd->inbuf = seg = alloc_pool(jd, JD_SZBUF);		/* Allocate stream input buffer */
 	if (!seg) return JDR_MEM1;
@@ -838,6 +1456,9 @@ JRESULT lgfx_jd_prepare (
 		ofs += 4 + len;	/* Number of bytes loaded */
 
 		switch (seg[1]) {	/* Marker */
+		case 0xC2:	/* SOF2 (progressive JPEG) */
+			jd->progressive = 1;
+			/* fall through */
 		case 0xC0:	/* SOF0 (baseline JPEG) */
 			/* Load segment data */
 			if (len > JD_SZBUF) return JDR_MEM2;
@@ -863,6 +1484,10 @@ JRESULT lgfx_jd_prepare (
 				b = seg[8 + 3 * i];							/* Get dequantizer table ID for this component */
 				if (b > 3) return JDR_FMT3;					/* Err: Invalid ID */
 				jd->qtid[i] = b;
+				jd->comp_id[i] = seg[6 + 3 * i];			/* Get component identifier */
+			}
+			if (jd->progressive && seg[5] == 1) {
+				jd->msx = jd->msy = 1;						/* Single component is not interleaved, MCU is a block */
 			}
 			break;
 
@@ -902,15 +1527,22 @@ JRESULT lgfx_jd_prepare (
 
 			if (!jd->width || !jd->height) return JDR_FMT1;	/* Err: Invalid image size */
 
-			if (seg[0] != jd->comps_in_frame) return JDR_FMT3;	/* Err: Supports only three color or grayscale components format */
+			if (jd->progressive) {
+				rc = set_scan(jd, seg, len);			/* Load parameters of the first scan */
+				if (rc) return (JRESULT)rc;
+			} else {
+				if (seg[0] != jd->comps_in_frame) return JDR_FMT3;	/* Err: Supports only three color or grayscale components format */
+			}
 
 			/* Check if all tables corresponding to each components have been loaded */
 			for (size_t i = 0; i < jd->comps_in_frame; ++i) {
-				uint_fast8_t b = seg[2 + 2 * i];	/* Get huffman table ID */
-				if (b != 0x00 && b != 0x11)	return JDR_FMT3;	/* Err: Different table number for DC/AC element */
-				b = i ? 1 : 0;
-				if (!jd->huffbits[b][0] || !jd->huffbits[b][1]) {	/* Check dc/ac huffman table for this component */
-					return JDR_FMT1;					/* Err: Nnot loaded */
+				if (!jd->progressive) {
+					uint_fast8_t b = seg[2 + 2 * i];	/* Get huffman table ID */
+					if (b != 0x00 && b != 0x11)	return JDR_FMT3;	/* Err: Different table number for DC/AC element */
+					b = i ? 1 : 0;
+					if (!jd->huffbits[b][0] || !jd->huffbits[b][1]) {	/* Check dc/ac huffman table for this component */
+						return JDR_FMT1;					/* Err: Nnot loaded */
+					}
 				}
 				if (!jd->qttbl[jd->qtid[i]]) {			/* Check dequantizer table for this component */
 					return JDR_FMT1;					/* Err: Not loaded */
@@ -940,7 +1572,6 @@ JRESULT lgfx_jd_prepare (
 			return JDR_OK;		/* Initialization succeeded. Ready to decompress the JPEG image. */
 
 		case 0xC1:	/* SOF1 */
-		case 0xC2:	/* SOF2 */
 		case 0xC3:	/* SOF3 */
 		case 0xC5:	/* SOF5 */
 		case 0xC6:	/* SOF6 */
@@ -952,7 +1583,7 @@ JRESULT lgfx_jd_prepare (
 		case 0xCE:	/* SOF14 */
 		case 0xCF:	/* SOF15 */
 		case 0xD9:	/* EOI */
-			return JDR_FMT3;	/* Unsuppoted JPEG standard (may be progressive JPEG) */
+			return JDR_FMT3;	/* Unsuppoted JPEG standard (may be lossless or arithmetic coding) */
 
 		default:	/* Unknown segment (comment, exif or etc..) */
 			/* Skip segment data */
@@ -976,8 +1607,19 @@ JRESULT lgfx_jd_decomp (
 	uint_fast8_t scale							/* Output de-scaling factor (0 to 3) */
 )
 {
-	uint32_t x, y, mx, my;
-	uint32_t nrst, rst, rsc;
+	return lgfx_jd_decomp_rect(jd, outfunc, scale, 0);
+}
+
+
+JRESULT lgfx_jd_decomp_rect (
+	lgfxJdec* jd,								/* Initialized decompression object */
+	uint32_t (*outfunc)(lgfxJdec*, void*, JRECT*),	/* RGB output function */
+	uint_fast8_t scale,							/* Output de-scaling factor (0 to 3) */
+	const JRECT* rect							/* Visible area in output pixels (NULL:whole image) */
+)
+{
+	uint32_t mx, my, cols, rows, cx0, cx1, cy0, cy1;
+	uint32_t i, end, nrst, rst;
 	JRESULT rc;
 
 
@@ -986,29 +1628,57 @@ JRESULT lgfx_jd_decomp (
 
 	nrst = jd->nrst;
 	mx = jd->msx << 3; my = jd->msy << 3;			/* Size of the MCU (pixel) */
+	cols = (jd->width  + mx - 1) / mx;				/* Number of MCUs in the image */
+	rows = (jd->height + my - 1) / my;
+
+	cx0 = cy0 = 0; cx1 = cols - 1; cy1 = rows - 1;	/* Visible MCU range */
+	if (rect) {
+		if (rect->left > rect->right || rect->top > rect->bottom) return JDR_OK;
+		cx0 = (rect->left << scale) / mx;
+		cy0 = (rect->top  << scale) / my;
+		if (cx1 > (((rect->right  + 1) << scale) - 1) / mx) cx1 = (((rect->right  + 1) << scale) - 1) / mx;
+		if (cy1 > (((rect->bottom + 1) << scale) - 1) / my) cy1 = (((rect->bottom + 1) << scale) - 1) / my;
+		if (cx0 > cx1 || cy0 > cy1) return JDR_OK;
+	}
+
+	if (jd->progressive) return prog_decomp(jd, outfunc, cx0, cx1, cy0, cy1);	/* All scans are needed before output */
 
 	jd->dcv[2] = jd->dcv[1] = jd->dcv[0] = 0;	/* Initialize DC values */
-	rst = rsc = 0;
+	rst = 0;	/* Number of MCUs processed in current restart interval */
 
 	rc = JDR_OK;
 
-	for (y = 0; y < jd->height; y += my) {		/* Vertical loop of MCUs */
-		x = 0;
-		do {	/* Horizontal loop of MCUs */
-			if (nrst && rst++ == nrst) {	/* Process restart interval if enabled */
-				rc = restart(jd, rsc++);
+	end = cy1 * cols + cx1 + 1;	/* MCUs after the last visible one are not needed */
+	for (i = 0; i < end; ) {
+		uint32_t x = i % cols, y = i / cols;
+		uint_fast8_t visible = (y >= cy0 && x >= cx0 && x <= cx1);
+		if (nrst && !visible) {	/* Jump over whole restart intervals that have no visible MCU */
+			uint32_t next = (y < cy0) ? cy0 * cols + cx0
+			              : (x < cx0) ? y * cols + cx0
+			                          : (y + 1) * cols + cx0;
+			uint32_t k = next / nrst, m = i / nrst;
+			if (k > m) {
+				rc = skip_restart(jd, k - m + (rst == nrst), k - 1);
 				if (rc != JDR_OK) return rc;
-				rst = 1;
+				i = k * nrst;
+				rst = 0;
+				continue;
 			}
-			rc = mcu_load(jd);					/* Load an MCU (decompress huffman coded stream and apply IDCT) */
+		}
+		if (nrst && rst == nrst) {	/* Process restart interval if enabled */
+			rc = restart(jd, i / nrst - 1);
 			if (rc != JDR_OK) return rc;
-			rc = mcu_output(jd, outfunc, x, y);	/* Output the MCU (color space conversion, scaling and output) */
+			rst = 0;
+		}
+		rc = mcu_load(jd, visible);			/* Load an MCU (decompress huffman coded stream and apply IDCT) */
+		if (rc != JDR_OK) return rc;
+		if (visible) {
+			rc = mcu_output(jd, outfunc, x * mx, y * my);	/* Output the MCU (color space conversion, scaling and output) */
 			if (rc != JDR_OK) return rc;
-		} while ( (x += mx) < jd->width);
+		}
+		++rst;
+		++i;
 	}
 
 	return rc;
 }
-
-
-
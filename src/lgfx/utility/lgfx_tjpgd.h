@@ -14,7 +14,7 @@
 /* System Configurations */
 
 #define	JD_SZBUF		512	/* Size of stream input buffer */
-#define JD_FORMAT		0	/* Output pixel format 0:RGB888 (3 BYTE/pix), 1:RGB565 (1 WORD/pix) */
+#define JD_FORMAT		0	/* Default output pixel format 0:RGB888 (3 BYTE/pix), 1:RGB565 (1 WORD/pix), 2:RGB565 byte swapped (big endian WORD/pix) */
 #define	JD_USE_SCALE	1	/* Use descaling feature for output */
 #define JD_TBLCLIP		0	/* Use table for saturation (might be a bit faster but increases 1K bytes of code size) */
 #define JD_BAYER		1	/* Use bayer pattern table */
@@ -73,6 +73,7 @@ struct lgfxJdec {
 	uint8_t* huffbits[2][2];	/* Huffman bit distribution tables [id][dcac] */
 	uint16_t* huffcode[2][2];	/* Huffman code word tables [id][dcac] */
 	uint8_t* huffdata[2][2];	/* Huffman decoded data tables [id][dcac] */
+	uint16_t huffcap[2][2];		/* Number of code words the tables can hold [id][dcac] */
 	int32_t* qttbl[4];			/* Dequantizer tables [id] */
 	void* workbuf;				/* Working buffer for IDCT and RGB output */
 	uint8_t* mcubuf;			/* Working buffer for the MCU */
@@ -81,6 +82,20 @@ struct lgfxJdec {
 	uint32_t (*infunc)(lgfxJdec*, uint8_t*, uint32_t);/* Pointer to jpeg stream input function */
 	void* device;				/* Pointer to I/O device identifiler for the session */
 	uint8_t comps_in_frame;		/* 1=Y(grayscale)  3=YCrCb */
+	uint8_t format;				/* Output pixel format (same as JD_FORMAT, can be changed between prepare and decomp) */
+	uint8_t dither;				/* Apply bayer pattern to the output (initial value:JD_BAYER) */
+
+	/* Progressive JPEG (SOF2). The caller provides the coefficient buffer between prepare and decomp. */
+	uint8_t progressive;		/* 1:progressive JPEG */
+	uint8_t comp_id[3];			/* Component identifiers in SOF */
+	uint8_t scan_nc;			/* Number of components in current scan */
+	uint8_t scan_cmp[3];		/* Component index of each component in current scan */
+	uint8_t scan_tbl[3];		/* Huffman table selectors (dc<<4|ac) of each component in current scan */
+	uint8_t ss, se, ah, al;		/* Spectral selection and successive approximation of current scan */
+	int16_t* coef;				/* Coefficient buffer (lgfx_jd_coef_size bytes for band_rows) */
+	uint8_t* nzmap;				/* Non-zero map (lgfx_jd_nzmap_size bytes), required when decoded in several bands */
+	uint16_t band_rows;			/* MCU rows decoded per pass over the input (0:all rows in one pass) */
+	uint32_t (*seekfunc)(lgfxJdec*, uint32_t);	/* Seek the stream to the offset from SOI (required when decoded in several bands) */
 };
 
 
@@ -88,6 +103,12 @@ struct lgfxJdec {
 /* TJpgDec API functions */
 JRESULT lgfx_jd_prepare (lgfxJdec*, uint32_t(*)(lgfxJdec*,uint8_t*,uint32_t), void*, uint_fast16_t, void*);
 JRESULT lgfx_jd_decomp (lgfxJdec*, uint32_t(*)(lgfxJdec*,void*,JRECT*), uint_fast8_t);
+/* Decompress only the MCUs overlapping the rectangle (in output pixels after descaling).
+   MCUs outside are entropy decoded without IDCT/output, or skipped by restart markers when DRI is present. */
+JRESULT lgfx_jd_decomp_rect (lgfxJdec*, uint32_t(*)(lgfxJdec*,void*,JRECT*), uint_fast8_t, const JRECT*);
+/* Progressive JPEG: size of the coefficient buffer for the MCU rows per pass (0:all rows), and of the non-zero map */
+uint32_t lgfx_jd_coef_size (lgfxJdec*, uint_fast16_t);
+uint32_t lgfx_jd_nzmap_size (lgfxJdec*);
 
 
 #ifdef __cplusplus
@@ -671,6 +671,98 @@ namespace lgfx
     endWrite();
   }
 
+  void LGFXBase::fillPolygon(const std::int32_t* points, std::size_t count, fill_rule_t rule)
+  {
+    if (count < 3) return;
+    static constexpr std::uint16_t stack_edges = 32;
+    if (count <= stack_edges)
+    {
+      path_buffer_t<stack_edges> path;
+      path.moveTo(points[0], points[1]);
+      for (std::size_t i = 1; i < count; ++i) { path.lineTo(points[i * 2], points[i * 2 + 1]); }
+      fillPath(path, rule);
+      return;
+    }
+    // large polygons : the edges and the active edge table are taken from the scratch arena.
+    if (count > UINT16_MAX) return;
+    ScratchArena::checkpoint_t cp(&_scratch);
+    auto edges = _scratch.allocate_array<path_edge_t>(count);
+    auto active = _scratch.allocate_array<path_active_t>(count);
+    if (!edges || !active) return;
+    path_t path(edges, active, count);
+    path.moveTo(points[0], points[1]);
+    for (std::size_t i = 1; i < count; ++i) { path.lineTo(points[i * 2], points[i * 2 + 1]); }
+    fillPath(path, rule);
+  }
+
+  void LGFXBase::fillPath(path_t& path, fill_rule_t rule)
+  { // active edge table scanline conversion
+    path.closePath();
+    std::size_t count = path.edgeCount();
+    if (!count) return;
+    path.sort();
+    auto edges = path.edges();
+    auto active = path.active();
+
+    std::int32_t y  = std::max<std::int32_t>(edges[0].y0, _clip_t);
+    std::int32_t ye = std::min<std::int32_t>(path.bottom(), _clip_b + 1);
+    std::size_t next = 0;
+    std::size_t an = 0;
+
+    startWrite();
+    for (; y < ye; ++y)
+    {
+      // retire the finished edges, then add the edges starting on this scanline.
+      std::size_t k = 0;
+      for (std::size_t i = 0; i < an; ++i)
+      {
+        if (edges[active[i].edge].y1 > y) { active[k++] = active[i]; }
+      }
+      an = k;
+      for (; next < count && edges[next].y0 <= y; ++next)
+      {
+        auto e = &edges[next];
+        if (e->y1 <= y) continue;
+        active[an].x = e->x + (std::int32_t)((std::int64_t)e->dx * (y - e->y0));
+        active[an].edge = next;
+        ++an;
+      }
+      if (an == 0)
+      {
+        if (next == count) break;
+        y = std::max<std::int32_t>(edges[next].y0, y + 1) - 1;
+        continue;
+      }
+
+      // keep the table sorted by x. it is almost sorted from the previous scanline.
+      for (std::size_t i = 1; i < an; ++i)
+      {
+        auto a = active[i];
+        std::size_t j = i;
+        for (; j && active[j - 1].x > a.x; --j) { active[j] = active[j - 1]; }
+        active[j] = a;
+      }
+
+      // pixels whose center is in [xa, xb) of each run.
+      std::int32_t wind = 0;
+      std::int32_t xa = 0;
+      for (std::size_t i = 0; i < an; ++i)
+      {
+        std::int32_t prev = wind;
+        wind = (rule == fill_evenodd) ? (wind ^ 1) : (wind + edges[active[i].edge].dir);
+        if (!prev) { xa = active[i].x; }
+        else if (!wind)
+        {
+          std::int32_t px0 = (xa           + 0xFFFF) >> 16;
+          std::int32_t px1 = (active[i].x  + 0xFFFF) >> 16;
+          if (px0 < px1) { writeFastHLine(px0, y, px1 - px0); }
+        }
+        active[i].x += edges[active[i].edge].dx;
+      }
+    }
+    endWrite();
+  }
+
   void LGFXBase::drawBezier( std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2)
   {
     std::int32_t x = x0 - x1, y = y0 - y1;
@@ -888,19 +980,24 @@ namespace lgfx
     endWrite();
   }
 
-  void LGFXBase::fillEllipseArc(std::int32_t x, std::int32_t y, std::int32_t r0x, std::int32_t r1x, std::int32_t r0y, std::int32_t r1y, float start, float end)
+  static void arc_normalize_angle(float& start, float& end)
   {
-    if (r0x < r1x) std::swap(r0x, r1x);
-    if (r0y < r1y) std::swap(r0y, r1y);
-    if (r1x < 0) return;
-    if (r1y < 0) return;
-
     bool equal = fabsf(start - end) < std::numeric_limits<float>::epsilon();
     start = fmodf(start, 360);
     end = fmodf(end, 360);
     if (start < 0) start += 360.0;
     if (end < 0) end += 360.0;
     if (!equal && (fabsf(start - end) <= 0.0001)) { start = .0; end = 360.0; }
+  }
+
+  void LGFXBase::fillEllipseArc(std::int32_t x, std::int32_t y, std::int32_t r0x, std::int32_t r1x, std::int32_t r0y, std::int32_t r1y, float start, float end)
+  {
+    if (r0x < r1x) std::swap(r0x, r1x);
+    if (r0y < r1y) std::swap(r0y, r1y);
+    if (r1x < 0) return;
+    if (r1y < 0) return;
+
+    arc_normalize_angle(start, end);
 
     startWrite();
     fill_arc_helper(x, y, r0x, r1x, r0y, r1y, start, end);
@@ -909,87 +1006,508 @@ namespace lgfx
 
   void LGFXBase::fill_arc_helper(std::int32_t cx, std::int32_t cy, std::int32_t oradius_x, std::int32_t iradius_x, std::int32_t oradius_y, std::int32_t iradius_y, float start, float end)
   {
-    float s_cos = (cosf(start * deg_to_rad));
-    float e_cos = (cosf(end * deg_to_rad));
-    float sslope = s_cos / (sinf(start * deg_to_rad));
-    float eslope = -1000000;
-    if (end != 360.0) eslope = e_cos / (sinf(end * deg_to_rad));
-    float swidth =  0.5 / s_cos;
-    float ewidth = -0.5 / e_cos;
+    std::int32_t y  = -oradius_y;
+    std::int32_t ye =  oradius_y;
+    if (y  < _clip_t - cy) y  = _clip_t - cy;
+    if (ye > _clip_b - cy) ye = _clip_b - cy;
+    if (y > ye) return;
 
-    bool start180 = !(start < 180);
-    bool end180 = end < 180;
-    bool reversed = start + 180 < end || (end < start && start < end + 180);
+    arc_span_generator_t gen(oradius_x, iradius_x, oradius_y, iradius_y, start, end);
+    range_t spans[arc_span_generator_t::max_spans];
+    do
+    {
+      std::size_t n = gen.getRow(y, spans);
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        writeFastHLine(cx + spans[i].first, cy + y, spans[i].length());
+      }
+    } while (++y <= ye);
+  }
 
-    std::int32_t xleft  = -oradius_x;
-    std::int32_t xright = oradius_x + 1;
-    std::int32_t y = -oradius_y;
-    std::int32_t ye = oradius_y;
-    if (!reversed)
+  static bool arc_spans_contains(const arc_spans_t::row_t* row, std::int32_t x)
+  {
+    for (std::int32_t i = 0; i < row->count; ++i)
     {
-      if (    (end >= 270 || end <  90) && (start >= 270 || start <  90)) xleft = 0;
-      else if (end <  270 && end >= 90  &&  start <  270 && start >= 90) xright = 1;
-      if (     end >= 180 && start >= 180) ye = 0;
-      else if (end <  180 && start <  180) y = 0;
+      if (x < row->x[i * 2]) break;
+      if (x <= row->x[i * 2 + 1]) return true;
     }
-    if (y  < _clip_t - cy    ) y  = _clip_t - cy;
-    if (ye > _clip_b - cy + 1) ye = _clip_b - cy + 1;
+    return false;
+  }
 
-    if (xleft  < _clip_l - cx    ) xleft  = _clip_l - cx;
-    if (xright > _clip_r - cx + 1) xright = _clip_r - cx + 1;
+  void LGFXBase::fill_arc_spans(arc_spans_t& spans, std::int32_t x, std::int32_t y, std::int32_t r0x, std::int32_t r1x, std::int32_t r0y, std::int32_t r1y, float start, float end, std::uint32_t fg_rawcolor, std::uint32_t bg_rawcolor)
+  {
+    if (r0x < r1x) std::swap(r0x, r1x);
+    if (r0y < r1y) std::swap(r0y, r1y);
+    if (r1x < 0) return;
+    if (r1y < 0) return;
 
-    bool trueCircle = (oradius_x == oradius_y) && (iradius_x == iradius_y);
+    arc_normalize_angle(start, end);
 
-    std::int32_t iradius_y2 = iradius_y * (iradius_y - 1);
-    std::int32_t iradius_x2 = iradius_x * (iradius_x - 1);
-    float irad_rate = iradius_x2 && iradius_y2 ? (float)iradius_x2 / (float)iradius_y2 : 0;
+    bool diff = spans.match(x, y, r0x, r1x, r0y, r1y);
+    if (!diff && !spans.reset(x, y, r0x, r1x, r0y, r1y))
+    { // no memory for the span list : draw the whole arc.
+      setRawColor(fg_rawcolor);
+      startWrite();
+      fill_arc_helper(x, y, r0x, r1x, r0y, r1y, start, end);
+      endWrite();
+      return;
+    }
+
+    arc_span_generator_t gen(r0x, r1x, r0y, r1y, start, end);
+    range_t cur[arc_span_generator_t::max_spans];
+    arc_spans_t::row_t next;
+    startWrite();
+    for (std::int32_t ry = -r0y; ry <= r0y; ++ry)
+    {
+      auto prev = spans.row(ry);
+      std::size_t n = gen.getRow(ry, cur);
+      next.count = n;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        next.x[i * 2    ] = cur[i].first;
+        next.x[i * 2 + 1] = cur[i].last;
+      }
+
+      std::int32_t py = y + ry;
+      if (py >= _clip_t && py <= _clip_b)
+      {
+        if (!diff)
+        {
+          setRawColor(fg_rawcolor);
+          for (std::size_t i = 0; i < n; ++i)
+          {
+            writeFastHLine(x + cur[i].first, py, cur[i].length());
+          }
+        }
+        else if (memcmp(prev, &next, sizeof(std::int16_t) * (1 + n * 2)))
+        { // symmetric difference between the previous and the current spans.
+          std::int32_t edges[arc_span_generator_t::max_spans * 4];
+          std::size_t en = 0;
+          for (std::int32_t i = 0; i < prev->count; ++i)
+          {
+            edges[en++] = prev->x[i * 2];
+            edges[en++] = prev->x[i * 2 + 1] + 1;
+          }
+          for (std::size_t i = 0; i < n; ++i)
+          {
+            edges[en++] = next.x[i * 2];
+            edges[en++] = next.x[i * 2 + 1] + 1;
+          }
+          for (std::size_t i = 1; i < en; ++i)
+          {
+            auto e = edges[i];
+            std::size_t j = i;
+            for (; j && edges[j - 1] > e; --j) { edges[j] = edges[j - 1]; }
+            edges[j] = e;
+          }
+          for (std::size_t i = 1; i < en; ++i)
+          {
+            std::int32_t x0 = edges[i - 1];
+            if (x0 == edges[i]) continue;
+            bool in_prev = arc_spans_contains(prev, x0);
+            bool in_next = arc_spans_contains(&next, x0);
+            if (in_prev == in_next) continue;
+            setRawColor(in_next ? fg_rawcolor : bg_rawcolor);
+            writeFastHLine(x + x0, py, edges[i] - x0);
+          }
+        }
+      }
+      memcpy(prev, &next, sizeof(arc_spans_t::row_t));
+    }
+    endWrite();
+  }
 
-    std::int32_t oradius_y2 = oradius_y * (oradius_y + 1);
-    std::int32_t oradius_x2 = oradius_x * (oradius_x + 1);
-    float orad_rate = oradius_x2 && oradius_y2 ? (float)oradius_x2 / (float)oradius_y2 : 0;
+  /// Output of 8bit coverage. Fully covered runs are filled, partially covered pixels are collected in a small
+  /// window of rows and blended with the pixels read back from the target as one rectangle, or with a background color.
+  /// 8bit被覆率の出力。完全に覆われた区間は塗りつぶし、部分的な画素は数行分の小さな矩形にまとめて
+  /// 読み戻した画素または背景色と合成する
+  struct smooth_writer_t
+  {
+    smooth_writer_t(LGFXBase* gfx, std::uint32_t fg_rgb888, std::uint32_t bg_rgb888, bool readback)
+    : _gfx { gfx }
+    , _fg_r { (std::int32_t)((fg_rgb888 >> 16) & 0xFF) }
+    , _fg_g { (std::int32_t)((fg_rgb888 >>  8) & 0xFF) }
+    , _fg_b { (std::int32_t)( fg_rgb888        & 0xFF) }
+    , _bg_r { (std::int32_t)((bg_rgb888 >> 16) & 0xFF) }
+    , _bg_g { (std::int32_t)((bg_rgb888 >>  8) & 0xFF) }
+    , _bg_b { (std::int32_t)( bg_rgb888        & 0xFF) }
+    , _fg_rgb888 { fg_rgb888 }
+    , _readback { readback }
+    {
+      gfx->getClipRect(&_clip_l, &_clip_t, &_clip_r, &_clip_b);
+      _clip_r += _clip_l - 1;
+      _clip_b += _clip_t - 1;
+    }
 
+    void put(std::int32_t x, std::int32_t y, std::uint_fast8_t alpha)
+    {
+      if (!alpha || x < _clip_l || x > _clip_r || y < _clip_t || y > _clip_b) return;
+      if (alpha == 255)
+      {
+        if (_run_len && (y != _run_y || x != _run_x + _run_len)) { flush_run(); }
+        if (!_run_len) { _run_x = x; _run_y = y; }
+        ++_run_len;
+        return;
+      }
+      if (_rect_w)
+      { // grow the window while it fits, a shallow or steep line stays in one rectangle for several steps.
+        std::int32_t l = std::min(x, _rect_x), r = std::max(x, _rect_x + _rect_w - 1);
+        std::int32_t t = std::min(y, _rect_y), b = std::max(y, _rect_y + _rect_h - 1);
+        if (r - l >= buf_w || b - t >= buf_h) { flush_rect(); }
+        else
+        {
+          _rect_x = l; _rect_w = r - l + 1;
+          _rect_y = t; _rect_h = b - t + 1;
+        }
+      }
+      if (!_rect_w) { _rect_x = x; _rect_y = y; _rect_w = 1; _rect_h = 1; }
+      // the window is addressed modulo its size, so it can grow in any direction without moving the entries.
+      _alpha[y & (buf_h - 1)][x & (buf_w - 1)] = alpha;
+    }
+
+    void flush(void)
+    {
+      flush_run();
+      flush_rect();
+    }
+
+  private:
+    static constexpr std::int32_t buf_w = 16;  // power of 2
+    static constexpr std::int32_t buf_h = 8;   // power of 2
+    LGFXBase* _gfx;
+    std::int32_t _fg_r, _fg_g, _fg_b;
+    std::int32_t _bg_r, _bg_g, _bg_b;
+    std::uint32_t _fg_rgb888;
+    std::int32_t _clip_l, _clip_t, _clip_r, _clip_b;
+    std::int32_t _run_x = 0, _run_y = 0, _run_len = 0;
+    std::int32_t _rect_x = 0, _rect_y = 0, _rect_w = 0, _rect_h = 0;
+    bool _readback;
+    std::uint8_t _alpha[buf_h][buf_w] = {};  // 0 : no pixel
+    bgr888_t _buf[buf_w * buf_h];
+
+    void flush_run(void)
+    {
+      if (!_run_len) return;
+      _gfx->setColor(_fg_rgb888);
+      _gfx->writeFastHLine(_run_x, _run_y, _run_len);
+      _run_len = 0;
+    }
+
+    void flush_rect(void)
+    {
+      std::int32_t w = _rect_w;
+      std::int32_t h = _rect_h;
+      if (!w) return;
+      _rect_w = 0;
+      if (_readback)
+      { // the pixels without coverage are written back unchanged.
+        _gfx->readRectRGB(_rect_x, _rect_y, w, h, _buf);
+      }
+      for (std::int32_t j = 0; j < h; ++j)
+      {
+        std::int32_t y = _rect_y + j;
+        auto alpha = _alpha[y & (buf_h - 1)];
+        auto buf = &_buf[j * w];
+        std::int32_t run = 0;
+        for (std::int32_t i = 0; i <= w; ++i)
+        {
+          std::int32_t x = _rect_x + i;
+          std::uint_fast8_t a = (i < w) ? alpha[x & (buf_w - 1)] : 0;
+          if (a)
+          {
+            alpha[x & (buf_w - 1)] = 0;
+            std::int32_t p = 1 + a;
+            auto bgr = &buf[i];
+            if (_readback)
+            {
+              bgr->r = (_fg_r * p + bgr->r * (257 - p)) >> 8;
+              bgr->g = (_fg_g * p + bgr->g * (257 - p)) >> 8;
+              bgr->b = (_fg_b * p + bgr->b * (257 - p)) >> 8;
+            }
+            else
+            {
+              bgr->r = (_fg_r * p + _bg_r * (257 - p)) >> 8;
+              bgr->g = (_fg_g * p + _bg_g * (257 - p)) >> 8;
+              bgr->b = (_fg_b * p + _bg_b * (257 - p)) >> 8;
+            }
+            ++run;
+          }
+          else if (run)
+          { // without readback the uncovered pixels must not be touched, each run of a row is sent by itself.
+            if (!_readback) { _gfx->pushImage(x - run, y, run, 1, &buf[i - run]); }
+            run = 0;
+          }
+        }
+      }
+      if (_readback) { _gfx->pushImage(_rect_x, _rect_y, w, h, _buf); }
+    }
+  };
+
+  void LGFXBase::fill_smooth_arc(std::int32_t x, std::int32_t y, std::int32_t r0x, std::int32_t r1x, std::int32_t r0y, std::int32_t r1y, float start, float end, std::uint32_t fg_rgb888, std::uint32_t bg_rgb888, bool readback)
+  {
+    if (r0x < r1x) std::swap(r0x, r1x);
+    if (r0y < r1y) std::swap(r0y, r1y);
+    if (r1x < 0) return;
+    if (r1y < 0) return;
+
+    arc_normalize_angle(start, end);
+
+    std::int32_t ry  = -r0y - 1;
+    std::int32_t rye =  r0y + 1;
+    if (ry  < _clip_t - y) ry  = _clip_t - y;
+    if (rye > _clip_b - y) rye = _clip_b - y;
+    if (ry > rye) return;
+    std::int32_t xl = _clip_l - x;
+    std::int32_t xr = _clip_r - x;
+
+    arc_span_generator_t gen(r0x, r1x, r0y, r1y, start, end);
+    // candidate pixels : the ring widened by one pixel on each side.
+    arc_span_generator_t ring(r0x + 1, r1x ? r1x - 1 : 0, r0y + 1, r1y ? r1y - 1 : 0, 0, 360);
+    range_t spans[arc_span_generator_t::max_spans];
+
+    startWrite();
+    smooth_writer_t writer(this, fg_rgb888, bg_rgb888, readback);
     do
     {
-      std::int32_t y2 = y * y;
-      std::int32_t compare_o = oradius_y2 - y2;
-      std::int32_t compare_i = iradius_y2 - y2;
-      if (!trueCircle)
+      std::size_t n = ring.getRow(ry, spans);
+      for (std::size_t i = 0; i < n; ++i)
       {
-        compare_i = floorf(compare_i * irad_rate);
-        compare_o = ceilf (compare_o * orad_rate);
+        std::int32_t px = std::max<std::int32_t>(spans[i].first, xl);
+        std::int32_t pe = std::min<std::int32_t>(spans[i].last , xr);
+        for (; px <= pe; ++px)
+        {
+          std::uint32_t cov = gen.getCoverage(px, ry);
+          writer.put(x + px, y + ry, (cov << 4) - (cov >> 4));
+        }
       }
-      std::int32_t xe = ceilf(sqrtf(compare_o));
-      std::int32_t x = 1 - xe;
+    } while (++ry <= rye);
+    writer.flush();
+    endWrite();
+  }
 
-      if ( x < xleft )  x = xleft;
-      if (xe > xright) xe = xright;
-      float ysslope = (y + swidth) * sslope;
-      float yeslope = (y + ewidth) * eslope;
-      int len = 0;
-      do
+  void LGFXBase::draw_smooth_line(float x0, float y0, float x1, float y1, std::uint32_t fg_rgb888, std::uint32_t bg_rgb888, bool readback)
+  { // Xiaolin Wu's line algorithm
+    bool steep = fabsf(y1 - y0) > fabsf(x1 - x0);
+    if (steep)
+    {
+      std::swap(x0, y0);
+      std::swap(x1, y1);
+    }
+    if (x0 > x1)
+    {
+      std::swap(x0, x1);
+      std::swap(y0, y1);
+    }
+    float dx = x1 - x0;
+    float gradient = (dx < std::numeric_limits<float>::epsilon()) ? 1.0f : (y1 - y0) / dx;
+
+    startWrite();
+    smooth_writer_t writer(this, fg_rgb888, bg_rgb888, readback);
+    auto plot = [&](std::int32_t x, float y, float gap)
+    {
+      std::int32_t iy = floorf(y);
+      float f = y - iy;
+      std::uint_fast8_t a0 = (1.0f - f) * gap * 255.0f + 0.5f;
+      std::uint_fast8_t a1 =         f  * gap * 255.0f + 0.5f;
+      if (steep)
       {
-        bool flg1 = start180 != (x <= ysslope);
-        bool flg2 =   end180 != (x <= yeslope);
-        std::int32_t x2 = x * x;
-        if (x2 >= compare_i
-         && ((flg1 && flg2) || (reversed && (flg1 || flg2)))
-         && x != xe
-         && x2 < compare_o)
+        writer.put(iy    , x, a0);
+        writer.put(iy + 1, x, a1);
+      }
+      else
+      {
+        writer.put(x, iy    , a0);
+        writer.put(x, iy + 1, a1);
+      }
+    };
+
+    std::int32_t xs = floorf(x0 + 0.5f);
+    std::int32_t xe = floorf(x1 + 0.5f);
+    float intery = y0 + gradient * (xs - x0);
+    if (xs == xe)
+    {
+      plot(xs, intery, x1 - x0 + (x0 == x1));
+    }
+    else
+    {
+      plot(xs, intery, 0.5f - (x0 - xs));
+      plot(xe, y0 + gradient * (xe - x0), 0.5f + (x1 - xe));
+
+      std::int32_t x = xs + 1;
+      // skip the columns outside the clip rect.
+      std::int32_t cl = steep ? _clip_t : _clip_l;
+      std::int32_t cr = steep ? _clip_b : _clip_r;
+      if (x < cl) x = cl;
+      if (xe > cr + 1) xe = cr + 1;
+      intery = y0 + gradient * (x - x0);
+      for (; x < xe; ++x)
+      {
+        plot(x, intery, 1.0f);
+        intery += gradient;
+      }
+    }
+    writer.flush();
+    endWrite();
+  }
+
+  void LGFXBase::draw_wide_line(float x0, float y0, float x1, float y1, float width, std::uint32_t fg_rgb888, std::uint32_t bg_rgb888, bool readback)
+  { // coverage from the distance to the segment (round caps)
+    float r = width * 0.5f;
+    if (!(r > 0)) return;
+    float ro = r + 0.5f;  // coverage 0 at and beyond this distance
+    float ri = r - 0.5f;  // coverage 1 within this distance
+    float cmax = (width < 1.0f) ? width : 1.0f;
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    float len2 = dx * dx + dy * dy;
+
+    std::int32_t py  = floorf(std::min(y0, y1) - ro);
+    std::int32_t pye =  ceilf(std::max(y0, y1) + ro);
+    if (py  < _clip_t) py  = _clip_t;
+    if (pye > _clip_b) pye = _clip_b;
+    if (py > pye) return;
+
+    startWrite();
+    smooth_writer_t writer(this, fg_rgb888, bg_rgb888, readback);
+    for (; py <= pye; ++py)
+    {
+      // part of the segment within ro vertically gives the candidate columns.
+      float ta = 0.0f, tb = 1.0f;
+      if (fabsf(dy) < std::numeric_limits<float>::epsilon())
+      {
+        if (fabsf(py - y0) >= ro) continue;
+      }
+      else
+      {
+        ta = (py - ro - y0) / dy;
+        tb = (py + ro - y0) / dy;
+        if (ta > tb) std::swap(ta, tb);
+        if (ta < 0.0f) ta = 0.0f;
+        if (tb > 1.0f) tb = 1.0f;
+        if (ta > tb) continue;
+      }
+      float xa = x0 + dx * ta;
+      float xb = x0 + dx * tb;
+      if (xa > xb) std::swap(xa, xb);
+      std::int32_t px = floorf(xa - ro);
+      std::int32_t pe =  ceilf(xb + ro);
+      if (px < _clip_l) px = _clip_l;
+      if (pe > _clip_r) pe = _clip_r;
+
+      float qy = py - y0;
+      for (; px <= pe; ++px)
+      {
+        float qx = px - x0;
+        float t = (len2 > 0.0f) ? (qx * dx + qy * dy) / len2 : 0.0f;
+        if (t < 0.0f) t = 0.0f; else if (t > 1.0f) t = 1.0f;
+        float ex = qx - t * dx;
+        float ey = qy - t * dy;
+        float d2 = ex * ex + ey * ey;
+        if (d2 >= ro * ro) continue;
+        float c = (ri > 0.0f && d2 <= ri * ri) ? 1.0f : ro - sqrtf(d2);
+        if (c > cmax) c = cmax;
+        writer.put(px, py, c * 255.0f + 0.5f);
+      }
+    }
+    writer.flush();
+    endWrite();
+  }
+
+  void LGFXBase::fill_smooth_polygon(const float* points, std::size_t count, std::uint32_t fg_rgb888, std::uint32_t bg_rgb888, bool readback)
+  { // scanline fill, 4 sub-scanlines per row with exact horizontal coverage (non-zero winding rule)
+    if (count < 3) return;
+    static constexpr std::int32_t sub = 4;
+    static constexpr std::int32_t unit = 256 / sub;
+
+    // pixel (px, py) covers [px - 0.5, px + 0.5) x [py - 0.5, py + 0.5).
+    float minx = points[0], maxx = points[0], miny = points[1], maxy = points[1];
+    for (std::size_t i = 1; i < count; ++i)
+    {
+      float px = points[i * 2];
+      float py = points[i * 2 + 1];
+      if (minx > px) minx = px; else if (maxx < px) maxx = px;
+      if (miny > py) miny = py; else if (maxy < py) maxy = py;
+    }
+    std::int32_t xl  = std::max<std::int32_t>(floorf(minx + 0.5f), _clip_l);
+    std::int32_t xr  = std::min<std::int32_t>(floorf(maxx + 0.5f), _clip_r);
+    std::int32_t py  = std::max<std::int32_t>(floorf(miny + 0.5f), _clip_t);
+    std::int32_t pye = std::min<std::int32_t>(floorf(maxy + 0.5f), _clip_b);
+    if (xl > xr || py > pye) return;
+    std::int32_t w = xr - xl + 1;
+
+    // coverage of partial pixels, run deltas of fully covered pixels, edge crossings and their winding direction.
+    ScratchArena::checkpoint_t cp(&_scratch);
+    auto acc   = _scratch.allocate_array<std::int16_t>((w + 1) * 2);
+    auto cross = _scratch.allocate_array<float>(count);
+    auto dir   = _scratch.allocate_array<std::int8_t>(count);
+    if (!acc || !cross || !dir) return;
+    auto delta = &acc[w + 1];
+
+    startWrite();
+    smooth_writer_t writer(this, fg_rgb888, bg_rgb888, readback);
+    for (; py <= pye; ++py)
+    {
+      memset(acc, 0, sizeof(std::int16_t) * (w + 1) * 2);
+      std::int32_t lo = w, hi = -1;
+      for (std::int32_t s = 0; s < sub; ++s)
+      {
+        float sy = py - 0.5f + (s + 0.5f) / sub;
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < count; ++i)
         {
-          ++len;
+          const float* p0 = &points[i * 2];
+          const float* p1 = &points[(i + 1 == count) ? 0 : (i * 2 + 2)];
+          if ((sy >= p0[1]) == (sy >= p1[1])) continue;
+          float cx = p0[0] + (sy - p0[1]) * (p1[0] - p0[0]) / (p1[1] - p0[1]) + 0.5f - xl;
+          std::int8_t d = (p1[1] > p0[1]) ? 1 : -1;
+          std::size_t k = n++;
+          for (; k && cross[k - 1] > cx; --k) { cross[k] = cross[k - 1]; dir[k] = dir[k - 1]; }
+          cross[k] = cx;
+          dir[k] = d;
         }
-        else
+
+        std::int32_t wind = 0;
+        float xa = 0;
+        for (std::size_t k = 0; k < n; ++k)
         {
-          if (len)
+          std::int32_t prev = wind;
+          wind += dir[k];
+          if (!prev) { xa = cross[k]; continue; }
+          if (wind) continue;
+          float xb = cross[k];
+          if (xa < 0) xa = 0;
+          if (xb > w) xb = w;
+          if (xb <= xa) continue;
+          std::int32_t ia = xa * 256;
+          std::int32_t ib = xb * 256;
+          std::int32_t pa = ia >> 8;
+          std::int32_t pb = ib >> 8;
+          if (pa == pb)
           {
-            writeFastHLine(cx + x - len, cy + y, len);
-            len = 0;
+            acc[pa] += (ib - ia) / sub;
           }
-          if (x2 >= compare_o) break;
-          if (x < 0 && x2 < compare_i) { x = -x; }
+          else
+          {
+            acc[pa] += (256 - (ia & 255)) / sub;
+            delta[pa + 1] += unit;
+            delta[pb] -= unit;
+            acc[pb] += (ib & 255) / sub;
+          }
+          if (lo > pa) lo = pa;
+          if (hi < pb) hi = pb;
         }
-      } while (++x <= xe);
-    } while (++y <= ye);
+      }
+      if (hi >= w) hi = w - 1;
+      std::int32_t run = 0;
+      for (std::int32_t i = lo; i <= hi; ++i)
+      {
+        run += delta[i];
+        std::int32_t a = acc[i] + run;
+        writer.put(xl + i, py, a > 255 ? 255 : a);
+      }
+    }
+    writer.flush();
+    endWrite();
   }
 
   void LGFXBase::draw_bitmap(std::int32_t x, std::int32_t y, const std::uint8_t *bitmap, std::int32_t w, std::int32_t h, std::uint32_t fg_rawcolor, std::uint32_t bg_rawcolor)
@@ -1456,7 +1974,9 @@ namespace lgfx
 
   struct paint_point_t { std::int32_t lx,rx,y,oy; };
 
-  static void paint_add_points(std::list<paint_point_t>& points, int lx, int rx, int y, int oy, bool* linebuf)
+  typedef std::list<paint_point_t, scratch_allocator_t<paint_point_t>> paint_list_t;
+
+  static void paint_add_points(paint_list_t& points, int lx, int rx, int y, int oy, bool* linebuf)
   {
     paint_point_t pt { 0, 0, y, oy };
     while (lx <= rx) {
@@ -1494,11 +2014,14 @@ namespace lgfx
     std::int32_t cl = _clip_l;
     int w = _clip_r - cl + 1;
     std::uint8_t bufIdx = 0;
-    bool* linebufs[3] = { new bool[w], new bool[w], new bool[w] };
+    ScratchArena::checkpoint_t cp(&_scratch);
+    bool* linebufs[3] = { _scratch.allocate_array<bool>(w), _scratch.allocate_array<bool>(w), _scratch.allocate_array<bool>(w) };
+    if (!linebufs[0] || !linebufs[1] || !linebufs[2]) return;
     std::int32_t bufY[3] = {-2, -2, -2};  // 3 line buffer (default: out of range.)
     bufY[0] = y;
     read_rect(cl, y, w, 1, linebufs[0], &p);
-    std::list<paint_point_t> points;
+    scratch_node_pool_t node_pool(&_scratch);
+    paint_list_t points { scratch_allocator_t<paint_point_t>(&node_pool) };
     points.push_back({x, x, y, y});
 
     startWrite();
@@ -1573,8 +2096,6 @@ namespace lgfx
         }
       } while ((newy += 2) < ly + 2);
     }
-    int i = 0;
-    do { delete[] linebufs[i]; } while (++i != 3);
     endWrite();
   }
 
@@ -2106,6 +2627,31 @@ namespace lgfx
 //----------------------------------------------------------------------------
 
   void LGFXBase::qrcode(const char *string, std::int32_t x, std::int32_t y, std::int32_t w, std::uint8_t version) {
+    std::uint16_t len = strlen(string);
+    /// the smallest version that holds the text is computed directly instead of trying each version.
+    std::uint8_t min_version = lgfx_qrcode_getMinVersion(ECC_LOW, (const std::uint8_t*)string, len);
+    if (version < min_version) { version = min_version; }
+
+    QRCode qrcode;
+    qrcode.size = 0;
+    bool valid = (min_version && version <= 40);
+    ScratchArena::checkpoint_t cp(&_scratch);
+    auto qrcodeData = _scratch.allocate_array<std::uint8_t>(lgfx_qrcode_getBufferSize(valid ? version : 1));
+    if (qrcodeData == nullptr) { valid = false; }
+    if (valid && 0 != lgfx_qrcode_initText(&qrcode, qrcodeData, version, ECC_LOW, string)) { qrcode.size = 0; }
+    this->qrcode(&qrcode, x, y, w);
+  }
+
+  static bool qrcode_row_equal(QRCode* qrcode, std::uint_fast8_t y0, std::uint_fast8_t y1)
+  {
+    std::uint_fast8_t x = 0;
+    do {
+      if (lgfx_qrcode_getModule(qrcode, x, y0) != lgfx_qrcode_getModule(qrcode, x, y1)) return false;
+    } while (++x < qrcode->size);
+    return true;
+  }
+
+  void LGFXBase::qrcode(const QRCode* qrcode, std::int32_t x, std::int32_t y, std::int32_t w) {
     if (w == -1) {
       w = std::min(width(), height()) * 9 / 10;
     }
@@ -2117,24 +2663,28 @@ namespace lgfx
     setColor(0xFFFFFFU);
     startWrite();
     writeFillRect(x, y, w, w);
-    for (; version <= 40; ++version) {
-      QRCode qrcode;
-      std::uint8_t qrcodeData[lgfx_qrcode_getBufferSize(version)];
-      if (0 != lgfx_qrcode_initText(&qrcode, qrcodeData, version, 0, string)) continue;
-      std::int_fast16_t thickness = w / qrcode.size;
-      if (!thickness) break;
-      std::int_fast16_t lineLength = qrcode.size * thickness;
+    auto qr = const_cast<QRCode*>(qrcode);
+    std::int_fast16_t size = qr ? qr->size : 0;
+    std::int_fast16_t thickness = size ? w / size : 0;
+    if (thickness) {
+      std::int_fast16_t lineLength = size * thickness;
       std::int_fast16_t xOffset = x + ((w - lineLength) >> 1);
       std::int_fast16_t yOffset = y + ((w - lineLength) >> 1);
       setColor(0);
+      /// dark modules are filled as horizontal runs, and identical rows are merged into one rect.
       y = 0;
       do {
+        std::int_fast16_t rows = 1;
+        while (y + rows < size && qrcode_row_equal(qr, y, y + rows)) { ++rows; }
         x = 0;
         do {
-          if (lgfx_qrcode_getModule(&qrcode, x, y)) writeFillRect(x * thickness + xOffset, y * thickness + yOffset, thickness, thickness);
-        } while (++x < qrcode.size);
-      } while (++y < qrcode.size);
-      break;
+          if (!lgfx_qrcode_getModule(qr, x, y)) { continue; }
+          std::int_fast16_t x0 = x;
+          while (++x < size && lgfx_qrcode_getModule(qr, x, y));
+          writeFillRect(x0 * thickness + xOffset, y * thickness + yOffset, (x - x0) * thickness, rows * thickness);
+        } while (++x < size);
+        y += rows;
+      } while (y < size);
     }
     endWrite();
   }
@@ -2208,20 +2758,44 @@ namespace lgfx
 
     if (maxWidth > 0 && maxHeight > 0)
     {
-      this->setClipRect(clip_x, clip_y, maxWidth, maxHeight);
+      bool rle = (bmpdata.biCompression == 1 && bpp == 8)
+              || (bmpdata.biCompression == 2 && bpp == 4);
+      if (!rle && (bmpdata.biCompression == 1 || bmpdata.biCompression == 2)) { return false; }
+
+      x -= offX;
+      y -= offY;
+
+      /// visible image rows (1 row margin for the affine rounding)
+      std::int32_t row_begin = std::max<std::int32_t>(0, floorf((clip_y             - y) / scale_y) - 1);
+      std::int32_t row_end   = std::min<std::int32_t>(h,  ceilf((clip_y + maxHeight - y) / scale_y) + 1);
+      if (row_begin >= row_end) { return true; }
+
+      std::uint32_t bytes_per_line = ((w * bpp + 31) >> 5) << 2;  // rows in the file are 4Byte aligned.
+      std::uint32_t packed_line = (w * bpp + 7) >> 3;             // rows in the strip are packed for pushImage.
+      static constexpr std::uint32_t strip_size = 4096;
+      std::int32_t strip_rows = std::max<std::int32_t>(1, std::min<std::int32_t>(h, strip_size / bytes_per_line));
+      auto strip = (std::uint8_t*)heap_alloc_dma(bytes_per_line * strip_rows);
+      if (strip == nullptr)
+      {
+        strip_rows = 1;
+        strip = (std::uint8_t*)heap_alloc_dma(bytes_per_line);
+        if (strip == nullptr) { return false; }
+      }
+
       argb8888_t *palette = nullptr;
       if (bpp <= 8) {
-        palette = (argb8888_t*)heap_alloc(sizeof(argb8888_t*) * (1 << bpp));
+        palette = (argb8888_t*)heap_alloc(sizeof(argb8888_t) * (1 << bpp));
+        if (palette == nullptr) { heap_free(strip); return false; }
         data->seek(bmpdata.biSize + 14);
         data->read((std::uint8_t*)palette, (1 << bpp)*sizeof(argb8888_t)); // load palette
       }
 
       data->seek(seekOffset);
 
+      this->setClipRect(clip_x, clip_y, maxWidth, maxHeight);
+
       auto dst_depth = this->_write_conv.depth;
-      std::uint32_t buffersize = ((w * bpp + 31) >> 5) << 2;  // readline 4Byte align.
-      std::uint8_t lineBuffer[buffersize + 4];
-      pixelcopy_t p(lineBuffer, dst_depth, (color_depth_t)bpp, this->_palette_count, palette);
+      pixelcopy_t p(strip, dst_depth, (color_depth_t)bpp, this->_palette_count, palette);
       p.no_convert = false;
       if (8 >= bpp && !this->_palette_count) {
         p.fp_copy = pixelcopy_t::get_fp_copy_palette_affine<argb8888_t>(dst_depth);
@@ -2234,55 +2808,69 @@ namespace lgfx
           p.fp_copy = pixelcopy_t::get_fp_copy_rgb_affine<argb8888_t>(dst_depth);
         }
       }
-      p.src_x32_add = (1u << FP_SCALE) / scale_x;
+      bool zoom = (scale_x != 1.0f || scale_y != 1.0f);
+      bitmap_rle_decoder_t rle_decoder(data, bpp, bmpdata.biSizeImage);
 
         //If the value of Height is positive, the image data is from bottom to top
         //If the value of Height is negative, the image data is from top to bottom.
-      std::int32_t flow = (bmpdata.biHeight > 0) ? -1 : 1;
-      if (bmpdata.biHeight > 0) y += ceilf(h * scale_y) - 1;
-
-      x -= offX;
-      y -= offY;
-
-      std::int32_t y32 = (y << FP_SCALE);
-      std::int32_t dst_y32_add = (1u << FP_SCALE) * scale_y;
-      if (bmpdata.biHeight > 0) dst_y32_add = - dst_y32_add;
+      bool bottom_up = (bmpdata.biHeight > 0);
 
       this->startWrite(!data->hasParent());
 
-      float affine[6] = { scale_x, 0.0f, (float)x, 0.0f, 1.0f, 0.0f };
-      p.src_bitwidth = w;
-      p.src_width = w;
-      p.src_height = 1;
-
-      do
+      /// strips are read in file order, and pushed top to bottom with one window each.
+      for (std::int32_t file_row = 0; file_row < h; file_row += strip_rows)
       {
+        std::int32_t rows = std::min(strip_rows, h - file_row);
+        std::int32_t top = bottom_up ? h - file_row - rows : file_row;  // first image row of this strip
+        if (bottom_up ? (top + rows <= row_begin) : (top >= row_end)) { break; }
+        bool visible = (top < row_end && top + rows > row_begin);
+
         data->preRead();
-        if (bmpdata.biCompression == 1)
+        if (rle)
         {
-          bmpdata.load_bmp_rle8(data, lineBuffer, w);
-        } else
-        if (bmpdata.biCompression == 2)
+          for (std::int32_t i = 0; i < rows; ++i)
+          {
+            rle_decoder.decodeLine(&strip[(bottom_up ? rows - 1 - i : i) * packed_line], w);
+          }
+        }
+        else if (!visible)
         {
-          bmpdata.load_bmp_rle4(data, lineBuffer, w);
+          data->skip(bytes_per_line * rows);
         }
         else
         {
-          data->read(lineBuffer, buffersize);
+          data->read(strip, bytes_per_line * rows);
+          if (packed_line != bytes_per_line)
+          {
+            for (std::int32_t i = 1; i < rows; ++i)
+            {
+              memmove(&strip[i * packed_line], &strip[i * bytes_per_line], packed_line);
+            }
+          }
+          if (bottom_up)
+          {
+            for (std::int32_t i = 0, j = rows - 1; i < j; ++i, --j)
+            {
+              std::swap_ranges(&strip[i * packed_line], &strip[(i + 1) * packed_line], &strip[j * packed_line]);
+            }
+          }
         }
         data->postRead();
-        y32 += dst_y32_add;
-        std::int32_t next_y = y32 >> FP_SCALE;
-        while (y != next_y)
+
+        if (!visible) { continue; }
+        if (zoom)
+        {
+          float affine[6] = { scale_x, 0.0f, (float)x, 0.0f, scale_y, y + top * scale_y };
+          this->push_image_affine(affine, w, rows, &p);
+        }
+        else
         {
-          p.src_x32 = 0;
-          affine[5] = y;
-          this->push_image_affine(affine, &p);
-          y += flow;
+          this->pushImage(x, y + top, w, rows, &p, false);
         }
-      } while (--h);
+      }
 
       if (palette != nullptr) heap_free(palette);
+      heap_free(strip);
       this->_clip_l = cl;
       this->_clip_t = ct;
       this->_clip_r = cr-1;
@@ -2302,6 +2890,8 @@ namespace lgfx
     pixelcopy_t *pc;
     float zoom_x;
     float zoom_y;
+    bool rgb565;
+    std::uint32_t start;
   };
 
   static std::uint32_t jpg_read_data(lgfxJdec  *decoder, std::uint8_t *buf, std::uint32_t len)
@@ -2318,6 +2908,14 @@ namespace lgfx
     return res;
   }
 
+  static std::uint32_t jpg_seek_data(lgfxJdec *decoder, std::uint32_t offset)
+  {
+    auto jpeg = (draw_jpg_info_t *)decoder->device;
+    auto data = (DataWrapper*)jpeg->data;
+    data->preRead();
+    return data->seek(jpeg->start + offset);
+  }
+
   static std::uint32_t jpg_push_image(lgfxJdec *decoder, void *bitmap, JRECT *rect)
   {
     draw_jpg_info_t *jpeg = static_cast<draw_jpg_info_t*>(decoder->device);
@@ -2352,25 +2950,36 @@ namespace lgfx
     { jpeg->zoom_x, 0.0f , x * jpeg->zoom_x + jpeg->x
     , 0.0f , jpeg->zoom_y, y * jpeg->zoom_y + jpeg->y
     };
-    jpeg->lgfx->pushImageAffine( affine, w, h, (bgr888_t*)jpeg->pc->src_data );
+    if (jpeg->rgb565)
+    {
+      jpeg->lgfx->pushImageAffine( affine, w, h, (swap565_t*)jpeg->pc->src_data );
+    }
+    else
+    {
+      jpeg->lgfx->pushImageAffine( affine, w, h, (bgr888_t*)jpeg->pc->src_data );
+    }
     return 1;
   }
 
   bool LGFXBase::draw_jpg(DataWrapper* data, std::int32_t x, std::int32_t y, std::int32_t maxWidth, std::int32_t maxHeight, std::int32_t offX, std::int32_t offY, float scale_x, float scale_y, datum_t datum)
   {
     draw_jpg_info_t jpeg;
-    pixelcopy_t pc(nullptr, this->getColorDepth(), bgr888_t::depth, this->hasPalette());
+    /// 16bit panels take swapped RGB565 straight from the decoder without the RGB888 stage.
+    jpeg.rgb565 = (this->getColorDepth() == swap565_t::depth);
+    pixelcopy_t pc(nullptr, this->getColorDepth(), jpeg.rgb565 ? swap565_t::depth : bgr888_t::depth, this->hasPalette());
     jpeg.pc = &pc;
     jpeg.lgfx = this;
     jpeg.data = data;
     jpeg.x = x - offX;
     jpeg.y = y - offY;
+    jpeg.start = data->tell();
 
     //TJpgD jpegdec;
     lgfxJdec jpegdec;
 
     static constexpr std::uint16_t sz_pool = 3100;
-    std::uint8_t *pool = (std::uint8_t*)heap_alloc_dma(sz_pool);
+    ScratchArena::checkpoint_t cp(&_scratch);
+    std::uint8_t *pool = (std::uint8_t*)_scratch.allocate(sz_pool, 8);
     if (!pool)
     {
       return false;
@@ -2380,9 +2989,30 @@ namespace lgfx
 
     if (jres != JDR_OK)
     {
-      heap_free(pool);
       return false;
     }
+    if (jpeg.rgb565) { jpegdec.format = 2; }
+
+    /// progressive JPEG keeps all coefficients until the last scan.
+    /// the whole image goes to PSRAM if possible, otherwise bands of MCU rows are decoded with passes over the data.
+    if (jpegdec.progressive)
+    {
+      jpegdec.coef = (std::int16_t*)heap_alloc_psram(lgfx_jd_coef_size(&jpegdec, 0));
+      if (jpegdec.coef == nullptr)
+      {
+        static constexpr std::uint32_t band_size = 16384;
+        std::uint32_t rows = band_size / lgfx_jd_coef_size(&jpegdec, 1);
+        jpegdec.band_rows = rows ? rows : 1;
+        jpegdec.seekfunc = jpg_seek_data;
+        jpegdec.nzmap = (std::uint8_t*)heap_alloc(lgfx_jd_nzmap_size(&jpegdec));
+        if (jpegdec.nzmap) { jpegdec.coef = (std::int16_t*)heap_alloc(lgfx_jd_coef_size(&jpegdec, jpegdec.band_rows)); }
+      }
+      if (jpegdec.coef == nullptr)
+      {
+        if (jpegdec.nzmap) heap_free(jpegdec.nzmap);
+        return false;
+      }
+    }
 
     const auto cl = this->_clip_l;
     const auto cr = this->_clip_r + 1;
@@ -2454,7 +3084,19 @@ namespace lgfx
       this->setClipRect(x, y, maxWidth, maxHeight);
       this->startWrite(!data->hasParent());
 
-      jres = lgfx_jd_decomp(&jpegdec, jpeg.zoom_x == 1.0f && jpeg.zoom_y == 1.0f ? jpg_push_image : jpg_push_image_affine, div);
+      /// visible area in decoder output pixels. (1 pixel margin for the affine rounding)
+      JRECT rect;
+      std::int32_t l = floorf((x              - jpeg.x) / jpeg.zoom_x) - 1;
+      std::int32_t t = floorf((y              - jpeg.y) / jpeg.zoom_y) - 1;
+      std::int32_t r =  ceilf((x + maxWidth  - jpeg.x) / jpeg.zoom_x);
+      std::int32_t b =  ceilf((y + maxHeight - jpeg.y) / jpeg.zoom_y);
+      rect.left   = std::max<std::int32_t>(0, l);
+      rect.top    = std::max<std::int32_t>(0, t);
+      rect.right  = std::max<std::int32_t>(0, r);
+      rect.bottom = std::max<std::int32_t>(0, b);
+      if (r < 0 || b < 0) { rect.right = 0; rect.left = 1; }
+
+      jres = lgfx_jd_decomp_rect(&jpegdec, jpeg.zoom_x == 1.0f && jpeg.zoom_y == 1.0f ? jpg_push_image : jpg_push_image_affine, div, &rect);
 
       this->_clip_l = cl;
       this->_clip_t = ct;
@@ -2462,7 +3104,11 @@ namespace lgfx
       this->_clip_b = cb-1;
       this->endWrite();
     }
-    heap_free(pool);
+    if (jpegdec.progressive)
+    {
+      heap_free(jpegdec.coef);
+      if (jpegdec.nzmap) heap_free(jpegdec.nzmap);
+    }
 
     if (jres != JDR_OK) {
 //ESP_LOGE("LGFX","jpeg decomp error:%x", jres);
@@ -2490,6 +3136,13 @@ namespace lgfx
     std::uint32_t last_x;
     std::int32_t scale_y0;
     std::int32_t scale_y1;
+    struct accum_t
+    {
+      std::uint32_t r, g, b, a, n;
+    };
+    accum_t* accum;         /// per destination column sums for the scaled row path
+    std::int32_t pending_y; /// destination row being accumulated (downscale)
+    bool blend;
   };
 
   static bool png_ypos_update(png_file_decoder_t *p, std::uint32_t y)
@@ -2509,10 +3162,23 @@ namespace lgfx
       p->gfx->pushImage(p->x, p->y + p->scale_y0, p->maxWidth, h, p->pc, true);
   }
 
+  /// background under the transparent pixels; an unreadable panel blends with the base color instead.
+  static void png_read_back(png_file_decoder_t *p, std::int32_t y, std::int32_t w, std::int32_t h, bgr888_t* dst)
+  {
+    if (p->gfx->isReadable())
+    {
+      p->gfx->readRectRGB(p->x, y, w, h, dst);
+      return;
+    }
+    std::uint32_t c = p->gfx->getBaseColor();
+    bgr888_t back { (std::uint8_t)(c >> 16), (std::uint8_t)(c >> 8), (std::uint8_t)c };
+    for (std::int32_t i = w * h; i > 0; --i) { *dst++ = back; }
+  }
+
   static void png_prepare_line(png_file_decoder_t *p, std::uint32_t y)
   {
     if (png_ypos_update(p, y))      // read next line
-      p->gfx->readRectRGB(p->x, p->y + p->scale_y0, p->maxWidth, p->scale_y1 - p->scale_y0, p->lineBuffer);
+      png_read_back(p, p->y + p->scale_y0, p->maxWidth, p->scale_y1 - p->scale_y0, p->lineBuffer);
   }
 
   static void png_done_callback(pngle_t *pngle)
@@ -2626,6 +3292,178 @@ namespace lgfx
     }
   }
 
+  static void png_push_span(png_file_decoder_t *p, std::int32_t l, std::int32_t r, std::int32_t t)
+  {
+    p->pc->src_data = &p->lineBuffer[l];
+    p->gfx->pushImage(p->x + l, p->y + t, r - l, 1, p->pc);
+  }
+
+  static void png_row_callback(pngle_t *pngle, std::uint32_t y, std::uint8_t *rgba, std::uint32_t)
+  {
+    auto p = (png_file_decoder_t*)lgfx_pngle_get_user_data(pngle);
+
+    std::int32_t t = y - p->offY;
+    if (t < 0 || t >= p->maxHeight) return;
+
+    auto src = &rgba[p->offX << 2];
+    auto dst = p->lineBuffer;
+    std::int32_t w = p->maxWidth;
+    if (p->blend)
+    {
+      png_read_back(p, p->y + t, w, 1, dst);
+      for (std::int32_t i = 0; i < w; ++i, src += 4)
+      {
+        std::uint_fast16_t a = src[3];
+        if (a == 255) { memcpy(&dst[i], src, 3); }
+        else if (a)
+        {
+          std::uint_fast16_t inv = 256 - a;
+          ++a;
+          dst[i].r = (src[0] * a + dst[i].r * inv) >> 8;
+          dst[i].g = (src[1] * a + dst[i].g * inv) >> 8;
+          dst[i].b = (src[2] * a + dst[i].b * inv) >> 8;
+        }
+      }
+      png_push_span(p, 0, w, t);
+      return;
+    }
+
+    /// without alpha channel, only the pixels hit by tRNS are transparent. push the opaque spans.
+    std::int32_t l = -1;
+    for (std::int32_t i = 0; i < w; ++i, src += 4)
+    {
+      if (src[3])
+      {
+        memcpy(&dst[i], src, 3);
+        if (l < 0) l = i;
+      }
+      else if (l >= 0)
+      {
+        png_push_span(p, l, i, t);
+        l = -1;
+      }
+    }
+    if (l >= 0) png_push_span(p, l, w, t);
+  }
+
+  /// Write the accumulated row to destination rows t..b-1 and clear the accumulator.
+  static void png_emit_accum(png_file_decoder_t *p, std::int32_t t, std::int32_t b)
+  {
+    auto acc = p->accum;
+    auto dst = p->lineBuffer;
+    std::int32_t w = p->maxWidth;
+    if (t < 0) t = 0;
+    if (b > p->maxHeight) b = p->maxHeight;
+    if (p->blend)
+    { /// out = (Σ c*a + bg * (n*255 - Σ a)) / (n*255)
+      for (; t < b; ++t)
+      {
+        png_read_back(p, p->y + t, w, 1, dst);
+        for (std::int32_t i = 0; i < w; ++i)
+        {
+          std::uint32_t n = acc[i].n * 255;
+          if (!n) continue;
+          std::uint32_t inv = n - acc[i].a;
+          std::uint32_t half = n >> 1;
+          dst[i].r = (acc[i].r + dst[i].r * inv + half) / n;
+          dst[i].g = (acc[i].g + dst[i].g * inv + half) / n;
+          dst[i].b = (acc[i].b + dst[i].b * inv + half) / n;
+        }
+        png_push_span(p, 0, w, t);
+      }
+    }
+    else if (t < b)
+    {
+      for (std::int32_t i = 0; i < w; ++i)
+      {
+        std::uint32_t a = acc[i].a;
+        if (!a) continue;
+        std::uint32_t half = a >> 1;
+        dst[i].r = (acc[i].r + half) / a;
+        dst[i].g = (acc[i].g + half) / a;
+        dst[i].b = (acc[i].b + half) / a;
+      }
+      for (; t < b; ++t)
+      {
+        std::int32_t l = -1;
+        for (std::int32_t i = 0; i < w; ++i)
+        {
+          if (acc[i].a) { if (l < 0) l = i; }
+          else if (l >= 0) { png_push_span(p, l, i, t); l = -1; }
+        }
+        if (l >= 0) png_push_span(p, l, w, t);
+      }
+    }
+    memset(acc, 0, sizeof(png_file_decoder_t::accum_t) * w);
+  }
+
+  /// Horizontal resample of one source row into the accumulator.
+  /// scale < 1 : box filter (every source pixel is added to exactly one column)  scale >= 1 : pixel replication
+  static void png_accum_row(png_file_decoder_t *p, const std::uint8_t *rgba, std::uint32_t w)
+  {
+    auto acc = p->accum;
+    float zx = p->zoom_x;
+    bool down = zx < 1.0f;
+    std::int32_t offX = p->offX;
+    std::int32_t maxWidth = p->maxWidth;
+    std::int32_t r = -offX;
+    for (std::uint32_t x = 0; x < w; ++x, rgba += 4)
+    {
+      std::int32_t l = r;
+      r = ceilf((x + 1) * zx) - offX;
+      if (r <= 0) continue;
+      if (l >= maxWidth) break;
+      std::uint32_t a = rgba[3];
+      if (down) { l = r - 1; }
+      else if (l < 0) { l = 0; }
+      std::int32_t e = std::min(r, maxWidth);
+      std::uint32_t cr = rgba[0] * a;
+      std::uint32_t cg = rgba[1] * a;
+      std::uint32_t cb = rgba[2] * a;
+      for (; l < e; ++l)
+      {
+        acc[l].r += cr;
+        acc[l].g += cg;
+        acc[l].b += cb;
+        acc[l].a += a;
+        acc[l].n += 1;
+      }
+    }
+  }
+
+  static void png_row_scale_callback(pngle_t *pngle, std::uint32_t y, std::uint8_t *rgba, std::uint32_t w)
+  {
+    auto p = (png_file_decoder_t*)lgfx_pngle_get_user_data(pngle);
+
+    if (p->zoom_y < 1.0f)
+    { /// several source rows are summed into one destination row
+      std::int32_t dy = ceilf((y + 1) * p->zoom_y) - 1 - p->offY;
+      if (dy != p->pending_y)
+      {
+        if (p->pending_y >= 0) png_emit_accum(p, p->pending_y, p->pending_y + 1);
+        p->pending_y = dy;
+      }
+      if (dy >= 0 && dy < p->maxHeight) png_accum_row(p, rgba, w);
+      return;
+    }
+
+    std::int32_t t = ceilf( y      * p->zoom_y) - p->offY;
+    std::int32_t b = ceilf((y + 1) * p->zoom_y) - p->offY;
+    if (b <= 0 || t >= p->maxHeight) return;
+    png_accum_row(p, rgba, w);
+    png_emit_accum(p, t, b);
+  }
+
+  static void png_done_scale_callback(pngle_t *pngle)
+  {
+    auto p = (png_file_decoder_t *)lgfx_pngle_get_user_data(pngle);
+    if (p->pending_y >= 0 && p->pending_y < p->maxHeight)
+    {
+      png_emit_accum(p, p->pending_y, p->pending_y + 1);
+    }
+    p->pending_y = -1;
+  }
+
   static void png_init_callback(pngle_t *pngle, std::uint32_t w, std::uint32_t h, uint_fast8_t hasTransparent)
   {
     auto p = (png_file_decoder_t*)lgfx_pngle_get_user_data(pngle);
@@ -2695,9 +3533,30 @@ namespace lgfx
     if (p->maxHeight > hh) p->maxHeight = hh;
     if (p->maxHeight < 0) return;
 
+    if (!lgfx_pngle_get_ihdr(pngle)->interlace)
+    { /// non-interlaced images are drawn row by row.
+      p->blend = hasTransparent;
+      p->lineBuffer = p->gfx->getScratchArena()->allocate_array<bgr888_t>(p->maxWidth);
+      if (p->lineBuffer == nullptr) return;
+      if (p->zoom_x == 1.0f && p->zoom_y == 1.0f)
+      {
+        lgfx_pngle_set_row_callback(pngle, png_row_callback);
+      }
+      else
+      {
+        p->accum = p->gfx->getScratchArena()->allocate_array<png_file_decoder_t::accum_t>(p->maxWidth);
+        if (p->accum == nullptr) return;
+        memset(p->accum, 0, sizeof(png_file_decoder_t::accum_t) * p->maxWidth);
+        p->pending_y = -1;
+        lgfx_pngle_set_row_callback(pngle, png_row_scale_callback);
+        lgfx_pngle_set_done_callback(pngle, png_done_scale_callback);
+      }
+      return;
+    }
+
     if (hasTransparent)
     { // need pixel read ?
-      p->lineBuffer = (bgr888_t*)heap_alloc_dma(sizeof(bgr888_t) * p->maxWidth * ceilf(p->zoom_x));
+      p->lineBuffer = p->gfx->getScratchArena()->allocate_array<bgr888_t>(p->maxWidth * ceilf(p->zoom_x));
       p->pc->src_data = p->lineBuffer;
       png_prepare_line(p, 0);
       lgfx_pngle_set_done_callback(pngle, png_done_callback);
@@ -2739,10 +3598,12 @@ namespace lgfx
     png.datum = datum;
     png.gfx = this;
     png.lineBuffer = nullptr;
+    png.accum = nullptr;
 
     pixelcopy_t pc(nullptr, this->getColorDepth(), bgr888_t::depth, this->_palette_count);
     png.pc = &pc;
 
+    ScratchArena::checkpoint_t cp(&_scratch);
     pngle_t *pngle = lgfx_pngle_new();
 
     lgfx_pngle_set_user_data(pngle, &png);
@@ -2772,10 +3633,7 @@ namespace lgfx
       data->preRead();
     }
     this->endWrite();
-    if (png.lineBuffer) {
-      this->waitDMA();
-      heap_free(png.lineBuffer);
-    }
+    if (png.lineBuffer) { this->waitDMA(); }
     lgfx_pngle_destroy(pngle);
     return res;
   }
@@ -2816,6 +3674,126 @@ namespace lgfx
     return res;
   }
 
+  static bool png_write_chunk(DataWriter* sink, const char* type, const void* data, std::uint32_t len)
+  {
+    std::uint8_t head[8] = { (std::uint8_t)(len >> 24), (std::uint8_t)(len >> 16), (std::uint8_t)(len >> 8), (std::uint8_t)len
+                           , (std::uint8_t)type[0], (std::uint8_t)type[1], (std::uint8_t)type[2], (std::uint8_t)type[3] };
+    mz_ulong crc = mz_crc32(MZ_CRC32_INIT, &head[4], 4);
+    if (len) { crc = mz_crc32(crc, (const std::uint8_t*)data, len); }
+    std::uint8_t tail[4] = { (std::uint8_t)(crc >> 24), (std::uint8_t)(crc >> 16), (std::uint8_t)(crc >> 8), (std::uint8_t)crc };
+    return sink->write(head, 8)
+        && (len == 0 || sink->write((const std::uint8_t*)data, len))
+        && sink->write(tail, 4);
+  }
+
+  /// tdefl flushes its output buffer here; every flush becomes one IDAT chunk.
+  static mz_bool png_idat_putter(const void* buf, int len, void* user)
+  {
+    return png_write_chunk(static_cast<DataWriter*>(user), "IDAT", buf, len);
+  }
+
+  /// Choose None / Sub / Up for the row by the minimum sum of absolute residuals.
+  /// Screens expanded from RGB565 have strongly correlated neighbours, so Sub / Up usually win.
+  static const std::uint8_t* png_filter_row(const std::uint8_t* cur, const std::uint8_t* prev, std::uint8_t* work, std::size_t len, std::uint8_t* filter)
+  {
+    std::uint32_t sum_none = 0, sum_sub = 0, sum_up = 0;
+    auto sub = work;
+    auto up = &work[len];
+    for (std::size_t i = 0; i < len; ++i)
+    {
+      std::uint8_t c = cur[i];
+      std::uint8_t s = c - (i < 3 ? 0 : cur[i - 3]);
+      sub[i] = s;
+      sum_none += abs((std::int8_t)c);
+      sum_sub  += abs((std::int8_t)s);
+      if (prev)
+      {
+        std::uint8_t u = c - prev[i];
+        up[i] = u;
+        sum_up += abs((std::int8_t)u);
+      }
+    }
+    if (prev && sum_up <= sum_sub && sum_up < sum_none) { *filter = 2; return up; }
+    if (sum_sub < sum_none) { *filter = 1; return sub; }
+    *filter = 0;
+    return cur;
+  }
+
+  bool LGFXBase::writePng(DataWriter* sink, std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, std::uint8_t level)
+  {
+    static constexpr std::uint32_t strip_bytes = 4096;
+    static constexpr mz_uint num_probes[11] = { 0, 1, 6, 32,  16, 32, 128, 256,  512, 768, 1500 };
+
+    if (sink == nullptr) return false;
+    if (_adjust_abs(x, w)||_adjust_abs(y, h)) return false;
+    if (x < 0) { w += x; x = 0; }
+    if (w > width() - x)  w = width()  - x;
+    if (w < 1) return false;
+    if (y < 0) { h += y; y = 0; }
+    if (h > height() - y) h = height() - y;
+    if (h < 1) return false;
+
+    std::size_t bpl = w * 3;
+    std::int32_t strip = std::max<std::int32_t>(1, std::min<std::int32_t>(h, strip_bytes / bpl));
+
+    auto comp = (tdefl_compressor*)heap_alloc_psram(sizeof(tdefl_compressor));
+    if (comp == nullptr) comp = (tdefl_compressor*)heap_alloc(sizeof(tdefl_compressor));
+    auto strip_buf = (std::uint8_t*)heap_alloc_dma(bpl * strip);
+    auto work = (std::uint8_t*)heap_alloc(bpl * 3);  // Sub, Up, previous row
+    bool res = comp && strip_buf && work;
+
+    if (res)
+    {
+      static constexpr std::uint8_t signature[8] = { 0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a };
+      std::uint8_t ihdr[13] = { 0, 0, (std::uint8_t)(w >> 8), (std::uint8_t)w
+                              , 0, 0, (std::uint8_t)(h >> 8), (std::uint8_t)h
+                              , 8, 2, 0, 0, 0 };  // 8bit truecolor, no interlace
+      res = sink->write(signature, sizeof(signature))
+         && png_write_chunk(sink, "IHDR", ihdr, sizeof(ihdr));
+    }
+
+    if (res)
+    {
+      level = std::min<std::uint8_t>(level, 10);
+      mz_uint flags = num_probes[level] | TDEFL_WRITE_ZLIB_HEADER | (level <= 3 ? TDEFL_GREEDY_PARSING_FLAG : 0);
+      if (level == 0) { flags |= TDEFL_FORCE_ALL_RAW_BLOCKS; }  // store : uncompressed deflate blocks only.
+      res = (TDEFL_STATUS_OKAY == tdefl_init(comp, png_idat_putter, sink, flags));
+    }
+
+    auto prev_buf = &work[bpl * 2];
+    const std::uint8_t* prev = nullptr;
+    for (std::int32_t sy = 0; res && sy < h; sy += strip)
+    {
+      std::int32_t rows = std::min(strip, h - sy);
+      readRectRGB(x, y + sy, w, rows, strip_buf);
+      for (std::int32_t i = 0; res && i < rows; ++i)
+      {
+        auto cur = &strip_buf[i * bpl];
+        std::uint8_t filter;
+        auto data = png_filter_row(cur, prev, work, bpl, &filter);
+        res = (0 <= tdefl_compress_buffer(comp, &filter, 1, TDEFL_NO_FLUSH))
+           && (0 <= tdefl_compress_buffer(comp, data, bpl, TDEFL_NO_FLUSH));
+        prev = cur;
+      }
+      if (res)
+      { /// the strip buffer is overwritten by the next read.
+        memcpy(prev_buf, prev, bpl);
+        prev = prev_buf;
+      }
+    }
+
+    if (res)
+    {
+      res = (TDEFL_STATUS_DONE == tdefl_compress_buffer(comp, nullptr, 0, TDEFL_FINISH))
+         && png_write_chunk(sink, "IEND", nullptr, 0);
+    }
+
+    if (work) heap_free(work);
+    if (strip_buf) heap_free(strip_buf);
+    if (comp) heap_free(comp);
+    return res;
+  }
+
 //----------------------------------------------------------------------------
 
   void LGFXBase::prepareTmpTransaction(DataWrapper* data)
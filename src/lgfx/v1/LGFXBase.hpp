@@ -28,10 +28,15 @@ Contributors:
 #include "misc/colortype.hpp"
 #include "misc/pixelcopy.hpp"
 #include "misc/DataWrapper.hpp"
+#include "misc/arc_spans.hpp"
+#include "misc/path.hpp"
+#include "misc/scratch_arena.hpp"
 #include "lgfx_fonts.hpp"
 #include "Touch.hpp"
 #include "panel/Panel_Device.hpp"
 
+struct QRCode;
+
 namespace lgfx
 {
  inline namespace v1
@@ -69,6 +74,10 @@ namespace lgfx
     LGFX_INLINE   color_conv_t* getColorConverter(void) { return &_write_conv; }
     LGFX_INLINE   color_depth_t getColorDepth(void) const { return _write_conv.depth; }
 
+    /// Scratch memory for the temporary buffers of floodFill, qrcode, drawJpg, drawPng and the VLW font. peak() reports the largest use.
+    /// floodFill, qrcode, drawJpg, drawPng, VLWフォントの一時バッファ用の領域。peak()で最大使用量を取得できる
+    LGFX_INLINE   ScratchArena* getScratchArena(void) { return &_scratch; }
+
     LGFX_INLINE   void startWrite(bool transaction = true) { _panel->startWrite(transaction); }
     LGFX_INLINE   void endWrite(void)                      { _panel->endWrite(); }
     LGFX_INLINE   void beginTransaction(void)              { _panel->beginTransaction(); }
@@ -116,6 +125,13 @@ namespace lgfx
                   void drawTriangle    ( std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2);
     LGFX_INLINE_T void fillTriangle    ( std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2, const T& color)  { setColor(color); fillTriangle(x0, y0, x1, y1, x2, y2); }
                   void fillTriangle    ( std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2);
+    /// Fill polygons and paths by scanline. The right and bottom edges are excluded, so polygons sharing an edge never overdraw each other.
+    /// 多角形・パスをスキャンラインで塗る。右端と下端は含まないため、辺を共有する多角形同士が重ね塗りにならない
+    /// @param points x,y pairs of the vertices
+    LGFX_INLINE_T void fillPolygon     ( const std::int32_t* points, std::size_t count, const T& color, fill_rule_t rule = fill_nonzero) { setColor(color); fillPolygon(points, count, rule); }
+                  void fillPolygon     ( const std::int32_t* points, std::size_t count, fill_rule_t rule = fill_nonzero);
+    LGFX_INLINE_T void fillPath        ( path_t& path, const T& color, fill_rule_t rule = fill_nonzero) { setColor(color); fillPath(path, rule); }
+                  void fillPath        ( path_t& path, fill_rule_t rule = fill_nonzero);
     LGFX_INLINE_T void drawBezier      ( std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2, const T& color)  { setColor(color); drawBezier(x0, y0, x1, y1, x2, y2); }
                   void drawBezier      ( std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2);
     LGFX_INLINE_T void drawBezier      ( std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2, std::int32_t x3, std::int32_t y3, const T& color)  { setColor(color); drawBezier(x0, y0, x1, y1, x2, y2, x3, y3); }
@@ -130,6 +146,29 @@ namespace lgfx
                   void drawArc         ( std::int32_t x, std::int32_t y, std::int32_t r0, std::int32_t r1, float angle0, float angle1)                 {                  drawEllipseArc( x, y, r0, r1, r0, r1, angle0, angle1); }
     LGFX_INLINE_T void fillArc         ( std::int32_t x, std::int32_t y, std::int32_t r0, std::int32_t r1, float angle0, float angle1, const T& color) { setColor(color); fillEllipseArc( x, y, r0, r1, r0, r1, angle0, angle1); }
                   void fillArc         ( std::int32_t x, std::int32_t y, std::int32_t r0, std::int32_t r1, float angle0, float angle1)                 {                  fillEllipseArc( x, y, r0, r1, r0, r1, angle0, angle1); }
+
+    /// Fill an arc and keep its spans in `spans`. When `spans` holds the previous arc of the same center and radii, only the difference is drawn (removed pixels in bgcolor).
+    /// 円弧を塗り、そのスパンを`spans`に保持する。同じ中心・半径の前回の円弧を保持している場合は差分のみを描画する(消えた画素はbgcolor)
+    LGFX_INLINE_T void fillEllipseArc  ( arc_spans_t& spans, std::int32_t x, std::int32_t y, std::int32_t r0x, std::int32_t r1x, std::int32_t r0y, std::int32_t r1y, float angle0, float angle1, const T& color, const T& bgcolor) { fill_arc_spans(spans, x, y, r0x, r1x, r0y, r1y, angle0, angle1, _write_conv.convert(color), _write_conv.convert(bgcolor)); }
+    LGFX_INLINE_T void fillArc         ( arc_spans_t& spans, std::int32_t x, std::int32_t y, std::int32_t r0, std::int32_t r1, float angle0, float angle1, const T& color, const T& bgcolor) { fill_arc_spans(spans, x, y, r0, r1, r0, r1, angle0, angle1, _write_conv.convert(color), _write_conv.convert(bgcolor)); }
+
+    /// Anti-aliased primitives. Partially covered pixels are blended with the pixels read back from readable panels / sprites,
+    /// or with the base color (setBaseColor) on write-only panels. The bgcolor variants always blend with bgcolor.
+    /// アンチエイリアス描画。部分的に覆われた画素は読出し可能なパネル・スプライトでは読み戻した画素と、
+    /// 読出しできないパネルではベースカラー(setBaseColor)と合成する。bgcolor指定版は常にbgcolorと合成する
+    LGFX_INLINE_T void drawSmoothLine      ( float x0, float y0, float x1, float y1, const T& color) { draw_smooth_line(x0, y0, x1, y1, convert_to_rgb888(color), _base_rgb888, smooth_readback()); }
+    LGFX_INLINE_T void drawWideLine        ( float x0, float y0, float x1, float y1, float width, const T& color) { draw_wide_line(x0, y0, x1, y1, width, convert_to_rgb888(color), _base_rgb888, smooth_readback()); }
+    LGFX_INLINE_T void drawSmoothCircle    ( std::int32_t x, std::int32_t y, std::int32_t r, const T& color) { fill_smooth_arc(x, y, r, r, r, r, 0, 360, convert_to_rgb888(color), _base_rgb888, smooth_readback()); }
+    LGFX_INLINE_T void fillSmoothCircle    ( std::int32_t x, std::int32_t y, std::int32_t r, const T& color) { fill_smooth_arc(x, y, r, 0, r, 0, 0, 360, convert_to_rgb888(color), _base_rgb888, smooth_readback()); }
+    LGFX_INLINE_T void fillSmoothEllipseArc( std::int32_t x, std::int32_t y, std::int32_t r0x, std::int32_t r1x, std::int32_t r0y, std::int32_t r1y, float angle0, float angle1, const T& color) { fill_smooth_arc(x, y, r0x, r1x, r0y, r1y, angle0, angle1, convert_to_rgb888(color), _base_rgb888, smooth_readback()); }
+    LGFX_INLINE_T void fillSmoothEllipseArc( std::int32_t x, std::int32_t y, std::int32_t r0x, std::int32_t r1x, std::int32_t r0y, std::int32_t r1y, float angle0, float angle1, const T& color, const T& bgcolor) { fill_smooth_arc(x, y, r0x, r1x, r0y, r1y, angle0, angle1, convert_to_rgb888(color), convert_to_rgb888(bgcolor), false); }
+    LGFX_INLINE_T void fillSmoothArc       ( std::int32_t x, std::int32_t y, std::int32_t r0, std::int32_t r1, float angle0, float angle1, const T& color) { fill_smooth_arc(x, y, r0, r1, r0, r1, angle0, angle1, convert_to_rgb888(color), _base_rgb888, smooth_readback()); }
+    LGFX_INLINE_T void fillSmoothArc       ( std::int32_t x, std::int32_t y, std::int32_t r0, std::int32_t r1, float angle0, float angle1, const T& color, const T& bgcolor) { fill_smooth_arc(x, y, r0, r1, r0, r1, angle0, angle1, convert_to_rgb888(color), convert_to_rgb888(bgcolor), false); }
+    LGFX_INLINE_T void fillSmoothTriangle  ( float x0, float y0, float x1, float y1, float x2, float y2, const T& color) { float p[] = { x0, y0, x1, y1, x2, y2 }; fill_smooth_polygon(p, 3, convert_to_rgb888(color), _base_rgb888, smooth_readback()); }
+    /// @param points x,y pairs of the vertices (non-zero winding rule)
+    LGFX_INLINE_T void fillSmoothPolygon   ( const float* points, std::size_t count, const T& color) { fill_smooth_polygon(points, count, convert_to_rgb888(color), _base_rgb888, smooth_readback()); }
+
+
     LGFX_INLINE_T void drawCircleHelper( std::int32_t x, std::int32_t y, std::int32_t r, std::uint_fast8_t cornername                 , const T& color)  { setColor(color); drawCircleHelper(x, y, r, cornername    ); }
                   void drawCircleHelper( std::int32_t x, std::int32_t y, std::int32_t r, std::uint_fast8_t cornername);
     LGFX_INLINE_T void fillCircleHelper( std::int32_t x, std::int32_t y, std::int32_t r, std::uint_fast8_t corners, std::int32_t delta, const T& color)  { setColor(color); fillCircleHelper(x, y, r, corners, delta); }
@@ -662,6 +701,10 @@ namespace lgfx
 #endif
     void qrcode(const char *string, std::int32_t x = -1, std::int32_t y = -1, std::int32_t width = -1, std::uint8_t version = 1);
 
+    /// Draw a symbol generated in advance with lgfx_qrcode_initText. (skips encoding for codes redrawn often)
+    /// lgfx_qrcode_initTextで生成済みのQRコードを描画する (頻繁に再描画するコードのエンコードを省略)
+    void qrcode(const QRCode* qrcode, std::int32_t x = -1, std::int32_t y = -1, std::int32_t width = -1);
+
 
     bool drawBmp(const std::uint8_t *bmp_data, std::uint32_t bmp_len, std::int32_t x=0, std::int32_t y=0, std::int32_t maxWidth=0, std::int32_t maxHeight=0, std::int32_t offX=0, std::int32_t offY=0, float scale_x = 1.0f, float scale_y = 0.0f, datum_t datum = datum_t::top_left)
     {
@@ -705,6 +748,11 @@ namespace lgfx
 
     void* createPng( std::size_t* datalen, std::int32_t x = 0, std::int32_t y = 0, std::int32_t width = 0, std::int32_t height = 0);
 
+    /// Encode the area as PNG and stream it to the sink. Memory use does not depend on the image size.
+    /// level : 0 (store) - 10 (best). 1-3 use the fast greedy parser.
+    /// 指定範囲をPNG形式でsinkへ逐次出力する。使用メモリ量は画像サイズに依存しない
+    bool writePng(DataWriter* sink, std::int32_t x = 0, std::int32_t y = 0, std::int32_t width = 0, std::int32_t height = 0, std::uint8_t level = 1);
+
 
 
     template<typename T>
@@ -731,6 +779,7 @@ namespace lgfx
     void prepareTmpTransaction(DataWrapper* data);
 
     IPanel* _panel = nullptr;
+    ScratchArena _scratch;
 
     std::int32_t _sx = 0, _sy = 0, _sw = 0, _sh = 0; // for scroll zone
     std::int32_t _clip_l = 0, _clip_r = -1, _clip_t = 0, _clip_b = -1; // clip rect
@@ -1040,6 +1089,12 @@ namespace lgfx
     void read_rect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, void* dst, pixelcopy_t* param);
     void draw_gradient_line( std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, uint32_t colorstart, uint32_t colorend );
     void fill_arc_helper(std::int32_t cx, std::int32_t cy, std::int32_t oradius_x, std::int32_t iradius_x, std::int32_t oradius_y, std::int32_t iradius_y, float start, float end);
+    void fill_arc_spans(arc_spans_t& spans, std::int32_t x, std::int32_t y, std::int32_t r0x, std::int32_t r1x, std::int32_t r0y, std::int32_t r1y, float start, float end, std::uint32_t fg_rawcolor, std::uint32_t bg_rawcolor);
+    void fill_smooth_arc(std::int32_t x, std::int32_t y, std::int32_t r0x, std::int32_t r1x, std::int32_t r0y, std::int32_t r1y, float start, float end, std::uint32_t fg_rgb888, std::uint32_t bg_rgb888, bool readback);
+    void fill_smooth_polygon(const float* points, std::size_t count, std::uint32_t fg_rgb888, std::uint32_t bg_rgb888, bool readback);
+    void draw_smooth_line(float x0, float y0, float x1, float y1, std::uint32_t fg_rgb888, std::uint32_t bg_rgb888, bool readback);
+    void draw_wide_line(float x0, float y0, float x1, float y1, float width, std::uint32_t fg_rgb888, std::uint32_t bg_rgb888, bool readback);
+    bool smooth_readback(void) const { return isReadable() && !hasPalette(); }
     void draw_bezier_helper(std::int32_t x0, std::int32_t y0, std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2);
     void draw_bitmap(std::int32_t x, std::int32_t y, const std::uint8_t *bitmap, std::int32_t w, std::int32_t h, std::uint32_t fg_rawcolor, std::uint32_t bg_rawcolor = ~0u);
     void draw_xbitmap(std::int32_t x, std::int32_t y, const std::uint8_t *bitmap, std::int32_t w, std::int32_t h, std::uint32_t fg_rawcolor, std::uint32_t bg_rawcolor = ~0u);
@@ -1179,6 +1234,13 @@ namespace lgfx
       *y = ty;
     }
 
+    bool sampleTouch(void) { return panel()->sampleTouch(); }
+    bool getTouchEvent(touch_event_t* ev) { return panel()->getTouchEvent(ev); }
+    std::size_t getTouchEventCount(void) const { return panel()->getTouchEventCount(); }
+    void setTouchFilter(bool median, std::uint8_t iir_shift) { panel()->setTouchFilter(median, iir_shift); }
+    bool startTouchTask(std::uint32_t interval_ms = 10, std::int_fast8_t core = -1) { return panel()->startTouchTask(interval_ms, core); }
+    void stopTouchTask(void) { panel()->stopTouchTask(); }
+
     // This requires a uint16_t array with 8 elements. ( or nullptr )
     template <typename T>
     void calibrateTouch(uint16_t *parameters, const T& color_fg, const T& color_bg, uint8_t size = 10)
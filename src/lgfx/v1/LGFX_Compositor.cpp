@@ -0,0 +1,358 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#include "LGFX_Compositor.hpp"
+
+#include "misc/pixelcopy.hpp"
+
+#include <cstring>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  static auto get_fp_blend(color_depth_t depth) -> std::uint32_t(*)(void*, std::uint32_t, std::uint32_t, pixelcopy_t*)
+  {
+    return (depth == rgb888_3Byte) ? pixelcopy_t::blend_rgb_fast<bgr888_t>
+         : (depth == rgb666_3Byte) ? pixelcopy_t::blend_rgb_fast<bgr666_t>
+         : (depth == rgb565_2Byte) ? pixelcopy_t::blend_rgb_fast<swap565_t>
+         : (depth == rgb332_1Byte) ? pixelcopy_t::blend_rgb_fast<rgb332_t>
+         : nullptr;
+  }
+
+  void LGFX_Compositor::release(void)
+  {
+    if (_buffer) { heap_free(_buffer); _buffer = nullptr; }
+    if (_argb) { heap_free(_argb); _argb = nullptr; }
+    _rgb = nullptr;
+    _buffer_capacity = 0;
+    _row_capacity = 0;
+  }
+
+  LGFX_Compositor::layer_t* LGFX_Compositor::get_layer(std::int_fast8_t id)
+  {
+    if (id < 0 || id >= max_layers || _layers[id].sprite == nullptr) return nullptr;
+    return &_layers[id];
+  }
+
+  void LGFX_Compositor::sort_layers(void)
+  {
+    // insertion sort, layers of the same z keep their order.
+    for (std::uint_fast8_t i = 1; i < _order_count; ++i)
+    {
+      auto id = _order[i];
+      auto z = _layers[id].z;
+      std::uint_fast8_t j = i;
+      for (; j && _layers[_order[j - 1]].z > z; --j)
+      {
+        _order[j] = _order[j - 1];
+      }
+      _order[j] = id;
+    }
+  }
+
+  std::int_fast8_t LGFX_Compositor::addLayer(LGFX_Sprite* sprite, std::int32_t x, std::int32_t y, std::int16_t z)
+  {
+    if (sprite == nullptr) return -1;
+    std::int_fast8_t id = 0;
+    while (_layers[id].sprite)
+    {
+      if (++id == max_layers) return -1;
+    }
+    auto l = &_layers[id];
+    l->sprite = sprite;
+    l->x = x;
+    l->y = y;
+    l->transp = pixelcopy_t::NON_TRANSP;
+    l->z = z;
+    l->alpha = 255;
+    l->visible = true;
+    _order[_order_count++] = id;
+    sort_layers();
+    damage_layer(l);
+    return id;
+  }
+
+  void LGFX_Compositor::removeLayer(std::int_fast8_t id)
+  {
+    auto l = get_layer(id);
+    if (l == nullptr) return;
+    damage_layer(l);
+    l->sprite = nullptr;
+    std::uint_fast8_t j = 0;
+    for (std::uint_fast8_t i = 0; i < _order_count; ++i)
+    {
+      if (_order[i] != id) { _order[j++] = _order[i]; }
+    }
+    _order_count = j;
+  }
+
+  void LGFX_Compositor::setPosition(std::int_fast8_t id, std::int32_t x, std::int32_t y)
+  {
+    auto l = get_layer(id);
+    if (l == nullptr || (l->x == x && l->y == y)) return;
+    damage_layer(l);
+    l->x = x;
+    l->y = y;
+    damage_layer(l);
+  }
+
+  void LGFX_Compositor::setZ(std::int_fast8_t id, std::int16_t z)
+  {
+    auto l = get_layer(id);
+    if (l == nullptr || l->z == z) return;
+    l->z = z;
+    sort_layers();
+    damage_layer(l);
+  }
+
+  void LGFX_Compositor::setAlpha(std::int_fast8_t id, std::uint8_t alpha)
+  {
+    auto l = get_layer(id);
+    if (l == nullptr || l->alpha == alpha) return;
+    l->alpha = alpha;
+    damage_layer(l);
+  }
+
+  void LGFX_Compositor::setVisible(std::int_fast8_t id, bool visible)
+  {
+    auto l = get_layer(id);
+    if (l == nullptr || l->visible == visible) return;
+    // damaged while visible, so both showing and hiding redraw the area.
+    if (!visible) { damage_layer(l); }
+    l->visible = visible;
+    damage_layer(l);
+  }
+
+  void LGFX_Compositor::set_transparent(layer_t* l, std::uint32_t transp)
+  {
+    if (l->transp == transp) return;
+    l->transp = transp;
+    damage_layer(l);
+  }
+
+  void LGFX_Compositor::invalidate(std::int_fast8_t id)
+  {
+    if (auto l = get_layer(id)) { damage_layer(l); }
+  }
+
+  void LGFX_Compositor::invalidate(std::int_fast8_t id, std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
+  {
+    auto l = get_layer(id);
+    if (l == nullptr || !l->visible) return;
+    // clipped to the sprite, the area outside of it does not belong to the layer.
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (w > l->sprite->width() - x) { w = l->sprite->width() - x; }
+    if (h > l->sprite->height() - y) { h = l->sprite->height() - y; }
+    add_damage(l->x + x, l->y + y, w, h);
+  }
+
+  void LGFX_Compositor::add_damage(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
+  {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (w > _dst->width() - x) { w = _dst->width() - x; }
+    if (h > _dst->height() - y) { h = _dst->height() - y; }
+    if (w < 1 || h < 1) return;
+
+    range_rect_t r;
+    r.l = x;
+    r.r = x + w - 1;
+    r.t = y;
+    r.b = y + h - 1;
+    // overlapping rectangles are merged, so no pixel is composed twice.
+    // when the list is full, the rectangle growing the least by the merge is chosen.
+    for (;;)
+    {
+      std::int_fast8_t merge = -1;
+      std::int32_t best = INT32_MAX;
+      for (std::uint_fast8_t i = 0; i < _damage_count; ++i)
+      {
+        auto& d = _damage[i];
+        if (d.l <= r.r && r.l <= d.r && d.t <= r.b && r.t <= d.b)
+        {
+          merge = i;
+          break;
+        }
+        if (_damage_count == max_damage)
+        {
+          std::int32_t grow = (std::int32_t)(std::max(d.r, r.r) - std::min(d.l, r.l) + 1)
+                            * (std::max(d.b, r.b) - std::min(d.t, r.t) + 1)
+                            - d.width() * d.height() - r.width() * r.height();
+          if (best > grow) { best = grow; merge = i; }
+        }
+      }
+      if (merge < 0) break;
+      auto& d = _damage[merge];
+      r.l = std::min(d.l, r.l);
+      r.r = std::max(d.r, r.r);
+      r.t = std::min(d.t, r.t);
+      r.b = std::max(d.b, r.b);
+      _damage[merge] = _damage[--_damage_count];
+    }
+    _damage[_damage_count++] = r;
+  }
+
+  bool LGFX_Compositor::covers(const layer_t* l, const range_rect_t& r) const
+  {
+    return l->visible && l->alpha == 255 && l->transp == pixelcopy_t::NON_TRANSP
+        && l->x <= r.l && r.r < l->x + l->sprite->width()
+        && l->y <= r.t && r.b < l->y + l->sprite->height();
+  }
+
+  void LGFX_Compositor::draw_layer(const layer_t* l, std::uint8_t* buf, std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, std::uint32_t bytes, pixelcopy_t* blend)
+  {
+    auto sprite = l->sprite;
+    std::int32_t sw = sprite->width();
+    std::int32_t sh = sprite->height();
+    std::int32_t left   = std::max(x, l->x);
+    std::int32_t right  = std::min(x + w, l->x + sw);
+    std::int32_t top    = std::max(y, l->y);
+    std::int32_t bottom = std::min(y + h, l->y + sh);
+    if (left >= right || top >= bottom || sprite->getBuffer() == nullptr) return;
+
+    auto dst_depth = _dst->getColorDepth();
+    bool opaque = (l->alpha == 255);
+    // an alpha layer is converted to rgb888 first, then blended with the argb8888 row.
+    pixelcopy_t p(sprite->getBuffer(), opaque ? dst_depth : rgb888_3Byte, sprite->getColorDepth(), false, sprite->getPalette(), l->transp);
+    p.src_width = sw;
+    p.src_height = sh;
+    p.src_bitwidth = sw;
+    if (p.src_bits < 8)
+    {
+      std::uint32_t x_mask = (p.src_bits == 1) ? 7
+                           : (p.src_bits == 2) ? 3
+                                               : 1;
+      p.src_bitwidth = (sw + x_mask) & (~x_mask);
+    }
+    bool raw_copy = opaque && p.no_convert && p.src_bits >= 8 && l->transp == pixelcopy_t::NON_TRANSP;
+
+    std::uint32_t index = left - x;
+    std::uint32_t last = right - x;
+    std::uint32_t len = last - index;
+    for (std::int32_t row = top; row < bottom; ++row)
+    {
+      auto line = &buf[(row - y) * w * bytes];
+      if (raw_copy)
+      {
+        auto src = static_cast<const std::uint8_t*>(sprite->getBuffer());
+        memcpy(&line[index * bytes], &src[((row - l->y) * sw + left - l->x) * bytes], len * bytes);
+        continue;
+      }
+      p.src_x32 = (left - l->x) << pixelcopy_t::FP_SCALE;
+      p.src_y32 = (row - l->y) << pixelcopy_t::FP_SCALE;
+      if (opaque)
+      {
+        std::uint32_t i = index;
+        do
+        {
+          i = p.fp_copy(line, i, last, &p);
+          if (i == last) break;
+          i = p.fp_skip(i, last, &p);
+        } while (i != last);
+        continue;
+      }
+
+      // opaque runs get the alpha of the layer, the transparent pixels 0.
+      std::uint32_t a = l->alpha;
+      std::uint32_t i = 0;
+      do
+      {
+        std::uint32_t end = p.fp_copy(_rgb, i, len, &p);
+        for (; i < end; ++i)
+        {
+          _argb[i].raw = a << 24 | _rgb[i].r << 16 | _rgb[i].g << 8 | _rgb[i].b;
+        }
+        if (end == len) break;
+        end = p.fp_skip(end, len, &p);
+        for (; i < end; ++i) { _argb[i].raw = 0; }
+      } while (i != len);
+      blend->src_data = _argb;
+      blend->src_x32 = 0;
+      blend->src_y32 = 0;
+      blend->src_bitwidth = len;
+      blend->fp_copy(line, index, last, blend);
+    }
+  }
+
+  bool LGFX_Compositor::update(void)
+  {
+    if (_damage_count == 0) return true;
+
+    auto depth = _dst->getColorDepth();
+    std::uint32_t bytes = (depth & color_depth_t::bit_mask) >> 3;
+    pixelcopy_t blend;
+    blend.fp_copy = get_fp_blend(depth);
+    if (_dst->hasPalette() || blend.fp_copy == nullptr) return false;
+    blend.src_x32_add = 1 << pixelcopy_t::FP_SCALE;
+    blend.src_y32_add = 0;
+
+    std::uint32_t width = _dst->width();
+    if (_buffer_capacity < width * bytes || _row_capacity < width)
+    {
+      release();
+      _buffer_capacity = std::max(_buffer_size, width * bytes);
+      _buffer = static_cast<std::uint8_t*>(heap_alloc_dma(_buffer_capacity));
+      // the argb8888 and rgb888 rows share one allocation.
+      _argb = static_cast<argb8888_t*>(heap_alloc(width * (sizeof(argb8888_t) + sizeof(bgr888_t))));
+      if (_buffer == nullptr || _argb == nullptr)
+      {
+        release();
+        return false;
+      }
+      _rgb = reinterpret_cast<bgr888_t*>(&_argb[width]);
+      _row_capacity = width;
+    }
+
+    std::uint32_t background = _dst->getColorConverter()->convert_rgb888(_background);
+    _dst->startWrite();
+    for (std::uint_fast8_t i = 0; i < _damage_count; ++i)
+    {
+      auto& d = _damage[i];
+      std::int32_t w = d.width();
+      std::int32_t rows = _buffer_capacity / (w * bytes);
+
+      // the layers below an opaque layer covering the whole rectangle are hidden.
+      std::uint_fast8_t first = _order_count;
+      while (first && !covers(&_layers[_order[first - 1]], d)) { --first; }
+      bool fill = (first == 0);
+      if (!fill) { --first; }
+
+      for (std::int32_t y = d.t; y <= d.b; y += rows)
+      {
+        std::int32_t h = std::min<std::int32_t>(rows, d.b - y + 1);
+        if (fill) { pixelcopy_t::fill_raw(_buffer, background, bytes, w * h); }
+        for (std::uint_fast8_t k = first; k < _order_count; ++k)
+        {
+          auto l = &_layers[_order[k]];
+          if (l->visible && l->alpha) { draw_layer(l, _buffer, d.l, y, w, h, bytes, &blend); }
+        }
+        pixelcopy_t pc(_buffer, depth, depth);
+        _dst->pushImage(d.l, y, w, h, &pc);
+      }
+    }
+    _dst->endWrite();
+    _damage_count = 0;
+    return true;
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
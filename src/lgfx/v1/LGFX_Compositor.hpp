@@ -0,0 +1,143 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "LGFXBase.hpp"
+#include "LGFX_Sprite.hpp"
+#include "misc/range.hpp"
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// Retained-mode compositor: keeps overlapping sprites as layers and redraws only the damaged areas.
+  /// Changing a layer (position, order, alpha, visibility, contents) marks its area as damaged,
+  /// update() composes the damaged rectangles row by row into a small buffer and sends them to the device.
+  /// The device must have a color depth of 8bit or more without palette. The layer sprites must not be rotated.
+  /// 重なり合うスプライトをレイヤーとして保持し、変化した領域のみを再描画する。
+  /// レイヤーの変更(位置・順序・アルファ・表示・内容)で領域を更新対象とし、
+  /// update()で更新領域を小さなバッファへ行単位で合成してデバイスに送信する。
+  /// デバイスはパレットなしの8bit以上の色深度であること。レイヤーのスプライトは回転させないこと
+  class LGFX_Compositor
+  {
+  public:
+    enum : std::uint8_t
+    { max_layers = 16
+    , max_damage = 8
+    };
+
+    struct layer_t
+    {
+      LGFX_Sprite* sprite;
+      std::int32_t x;
+      std::int32_t y;
+      std::uint32_t transp;  // raw color in the depth of the sprite, NON_TRANSP : none
+      std::int16_t z;
+      std::uint8_t alpha;
+      bool visible;
+    };
+
+    LGFX_Compositor(LovyanGFX* dst) : _dst { dst } {}
+    LGFX_Compositor(const LGFX_Compositor&) = delete;
+    LGFX_Compositor& operator=(const LGFX_Compositor&) = delete;
+    ~LGFX_Compositor(void) { release(); }
+
+    /// Size of the scanline buffer in bytes. At least one row of the device is allocated.
+    /// 合成バッファのバイト数。最低でもデバイスの1行分を確保する
+    void setBufferSize(std::uint32_t length) { release(); _buffer_size = length; }
+    std::uint32_t getBufferSize(void) const { return _buffer_size; }
+
+    /// Free the scanline buffer, it is allocated again by the next update().
+    void release(void);
+
+    /// Color below all layers.
+    template<typename T>
+    void setBackground(const T& color) { _background = convert_to_rgb888(color); invalidateAll(); }
+
+    /// Add a layer, returns its id or -1 when all layers are used. Layers with a higher z are drawn above.
+    /// レイヤーを追加し、そのIDを返す(空きがない場合は-1)。zが大きいレイヤーほど上に描画する
+    std::int_fast8_t addLayer(LGFX_Sprite* sprite, std::int32_t x = 0, std::int32_t y = 0, std::int16_t z = 0);
+    void removeLayer(std::int_fast8_t id);
+
+    void setPosition(std::int_fast8_t id, std::int32_t x, std::int32_t y);
+    void setZ(std::int_fast8_t id, std::int16_t z);
+    /// 0 : invisible, 255 : opaque.
+    void setAlpha(std::int_fast8_t id, std::uint8_t alpha);
+    void setVisible(std::int_fast8_t id, bool visible);
+
+    /// Pixels of this color are not drawn, as pushSprite(dst, x, y, transp).
+    template<typename T>
+    void setTransparent(std::int_fast8_t id, const T& color)
+    {
+      if (auto l = get_layer(id))
+      {
+        auto conv = l->sprite->getColorConverter();
+        set_transparent(l, conv->convert(color) & conv->colormask);
+      }
+    }
+    void clearTransparent(std::int_fast8_t id) { if (auto l = get_layer(id)) { set_transparent(l, pixelcopy_t::NON_TRANSP); } }
+
+    /// The whole sprite of the layer has been redrawn.
+    void invalidate(std::int_fast8_t id);
+    /// A part of the sprite of the layer has been redrawn (sprite coordinates).
+    void invalidate(std::int_fast8_t id, std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h);
+    /// Damage an area of the device.
+    void invalidateRect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h) { add_damage(x, y, w, h); }
+    void invalidateAll(void) { add_damage(0, 0, _dst->width(), _dst->height()); }
+
+    const layer_t* getLayer(std::int_fast8_t id) const { return const_cast<LGFX_Compositor*>(this)->get_layer(id); }
+    bool isDirty(void) const { return _damage_count; }
+
+    /// Compose the damaged rectangles and send them to the device.
+    /// Returns false when the device depth is unsupported or no buffer is available, the damage is kept.
+    /// 更新領域を合成してデバイスへ送信する。非対応の色深度かバッファ確保に失敗した場合はfalse(更新領域は保持される)
+    bool update(void);
+
+  private:
+    LovyanGFX* _dst;
+    layer_t _layers[max_layers] = {};
+    std::uint8_t _order[max_layers];  // ids of the layers from bottom to top
+    std::uint8_t _order_count = 0;
+
+    range_rect_t _damage[max_damage];
+    std::uint8_t _damage_count = 0;
+
+    std::uint32_t _background = 0;
+    std::uint32_t _buffer_size = 4096;
+    std::uint8_t* _buffer = nullptr;     // scanline buffer, depth of the device
+    argb8888_t* _argb = nullptr;         // one layer row for alpha blending
+    bgr888_t* _rgb = nullptr;
+    std::uint32_t _buffer_capacity = 0;  // bytes of _buffer
+    std::uint32_t _row_capacity = 0;     // pixels of _argb and _rgb
+
+    layer_t* get_layer(std::int_fast8_t id);
+    void set_transparent(layer_t* l, std::uint32_t transp);
+    void sort_layers(void);
+    void damage_layer(const layer_t* l) { if (l->visible) { add_damage(l->x, l->y, l->sprite->width(), l->sprite->height()); } }
+    void add_damage(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h);
+    bool covers(const layer_t* l, const range_rect_t& r) const;
+    void draw_layer(const layer_t* l, std::uint8_t* buf, std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, std::uint32_t bytes, pixelcopy_t* blend);
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
+
+using LGFX_Compositor = lgfx::LGFX_Compositor;
@@ -0,0 +1,451 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#include "LGFX_DisplayList.hpp"
+
+#include "misc/pixelcopy.hpp"
+
+#include <cstring>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  color_depth_t Panel_DisplayList::setColorDepth(color_depth_t depth)
+  {
+    // only byte depths without palette, so a row of pixels is a plain byte array.
+    std::uint_fast8_t bits = depth & color_depth_t::bit_mask;
+    if (bits < 8 || bits > 24 || (depth & color_depth_t::has_palette)) { depth = rgb565_2Byte; }
+    reset();
+    _write_depth = depth;
+    _read_depth = depth;
+    _write_bits = depth & color_depth_t::bit_mask;
+    _read_bits = _write_bits;
+    return depth;
+  }
+
+  void Panel_DisplayList::setRotation(std::uint_fast8_t r)
+  {
+    // the strips are filled row by row, the list is always recorded without rotation.
+    _rotation = 0;
+  }
+
+  void Panel_DisplayList::setSize(std::uint_fast16_t w, std::uint_fast16_t h)
+  {
+    reset();
+    _width = w;
+    _height = h;
+    _xs = _ys = 0;
+    _xe = w - 1;
+    _ye = h - 1;
+  }
+
+  void Panel_DisplayList::reset(void)
+  {
+    _cmd_count = 0;
+    _data_len = 0;
+    _overflow = false;
+  }
+
+  void Panel_DisplayList::release(void)
+  {
+    reset();
+    if (_cmds) { heap_free(_cmds); _cmds = nullptr; }
+    if (_data) { heap_free(_data); _data = nullptr; }
+    _cmd_capacity = 0;
+    _data_capacity = 0;
+  }
+
+  bool Panel_DisplayList::grow(void** buf, std::uint32_t* capacity, std::uint32_t need, std::uint32_t used)
+  {
+    std::uint32_t cap = *capacity ? *capacity : 256;
+    while (cap < need) { cap <<= 1; }
+    void* b = _psram ? heap_alloc_psram(cap) : nullptr;
+    if (b == nullptr) { b = heap_alloc(cap); }
+    if (b == nullptr)
+    {
+      _overflow = true;
+      return false;
+    }
+    if (*buf)
+    {
+      memcpy(b, *buf, used);
+      heap_free(*buf);
+    }
+    *buf = b;
+    *capacity = cap;
+    return true;
+  }
+
+  void Panel_DisplayList::add_cmd(display_list_cmd_t::type_t type, std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, std::uint32_t value)
+  {
+    std::uint32_t need = (_cmd_count + 1) * sizeof(display_list_cmd_t);
+    std::uint32_t cap = _cmd_capacity * sizeof(display_list_cmd_t);
+    if (need > cap)
+    {
+      if (!grow(reinterpret_cast<void**>(&_cmds), &cap, need, _cmd_count * sizeof(display_list_cmd_t))) return;
+      _cmd_capacity = cap / sizeof(display_list_cmd_t);
+    }
+    auto c = &_cmds[_cmd_count++];
+    c->type = type;
+    c->x = x;
+    c->y = y;
+    c->w = w;
+    c->h = h;
+    c->value = value;
+  }
+
+  /// returns the offset of len bytes in the data area, ~0u when no memory is available.
+  std::uint32_t Panel_DisplayList::alloc_data(std::uint32_t len)
+  {
+    std::uint32_t pos = (_data_len + 7) & ~7u;
+    if (pos + len > _data_capacity
+     && !grow(reinterpret_cast<void**>(&_data), &_data_capacity, pos + len, _data_len))
+    {
+      return ~0u;
+    }
+    _data_len = pos + len;
+    return pos;
+  }
+
+  void Panel_DisplayList::setWindow(std::uint_fast16_t xs, std::uint_fast16_t ys, std::uint_fast16_t xe, std::uint_fast16_t ye)
+  {
+    _xpos = _xs = std::min<std::uint_fast16_t>(xs, _width - 1);
+    _ypos = _ys = std::min<std::uint_fast16_t>(ys, _height - 1);
+    _xe = std::min<std::uint_fast16_t>(std::max(xs, xe), _width - 1);
+    _ye = std::min<std::uint_fast16_t>(std::max(ys, ye), _height - 1);
+  }
+
+  void Panel_DisplayList::drawPixelPreclipped(std::uint_fast16_t x, std::uint_fast16_t y, std::uint32_t rawcolor)
+  {
+    add_cmd(display_list_cmd_t::fill, x, y, 1, 1, rawcolor);
+  }
+
+  void Panel_DisplayList::writeFillRectPreclipped(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, std::uint32_t rawcolor)
+  {
+    add_cmd(display_list_cmd_t::fill, x, y, w, h, rawcolor);
+  }
+
+  void Panel_DisplayList::writeBlock(std::uint32_t rawcolor, std::uint32_t len)
+  {
+    // the run through the window is split into the rest of the current row, whole rows and the head of the last row.
+    std::uint32_t ww = _xe - _xs + 1;
+    while (len)
+    {
+      if (_xpos == _xs && len >= ww)
+      {
+        std::uint32_t rows = std::min<std::uint32_t>(len / ww, _ye - _ypos + 1);
+        add_cmd(display_list_cmd_t::fill, _xs, _ypos, ww, rows, rawcolor);
+        len -= rows * ww;
+        _ypos += rows;
+      }
+      else
+      {
+        std::uint32_t n = std::min<std::uint32_t>(len, _xe - _xpos + 1);
+        add_cmd(display_list_cmd_t::fill, _xpos, _ypos, n, 1, rawcolor);
+        len -= n;
+        _xpos += n;
+        if (_xpos <= _xe) return;
+        _xpos = _xs;
+        ++_ypos;
+      }
+      if (_ypos > _ye) { _ypos = _ys; }
+    }
+  }
+
+  /// copy one row of the source, the opaque runs become image commands.
+  void Panel_DisplayList::record_row(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, pixelcopy_t* param)
+  {
+    std::uint32_t bytes = _write_bits >> 3;
+    std::uint32_t offset = alloc_data(w * bytes);
+    if (offset == ~0u) return;
+    auto buf = &_data[offset];
+    std::uint32_t pos = 0;
+    do
+    {
+      std::uint32_t end = param->fp_copy(buf, pos, w, param);
+      if (end != pos) { add_cmd(display_list_cmd_t::image, x + pos, y, end - pos, 1, offset + pos * bytes); }
+      if (end == w) break;
+      pos = param->fp_skip(end, w, param);
+    } while (pos != w);
+  }
+
+  void Panel_DisplayList::writePixels(pixelcopy_t* param, std::uint32_t len)
+  {
+    do
+    {
+      std::uint32_t n = std::min<std::uint32_t>(len, _xe - _xpos + 1);
+      record_row(_xpos, _ypos, n, param);
+      len -= n;
+      _xpos += n;
+      if (_xpos > _xe)
+      {
+        _xpos = _xs;
+        if (++_ypos > _ye) { _ypos = _ys; }
+      }
+    } while (len);
+  }
+
+  void Panel_DisplayList::writeImage(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, pixelcopy_t* param, bool)
+  {
+    std::uint32_t sx32 = param->src_x32;
+    std::uint32_t sy32 = param->src_y32;
+    if (param->transp == pixelcopy_t::NON_TRANSP)
+    { // opaque images are kept as one command.
+      std::uint32_t bytes = _write_bits >> 3;
+      std::uint32_t offset = alloc_data(w * h * bytes);
+      if (offset == ~0u) return;
+      std::uint32_t pos = 0;
+      for (std::uint32_t i = 0; i < h; ++i)
+      {
+        param->fp_copy(&_data[offset], pos, pos + w, param);
+        pos += w;
+        param->src_x32 = sx32;
+        param->src_y32 = (sy32 += 1 << pixelcopy_t::FP_SCALE);
+      }
+      add_cmd(display_list_cmd_t::image, x, y, w, h, offset);
+      return;
+    }
+    do
+    {
+      record_row(x, y, w, param);
+      param->src_x32 = sx32;
+      param->src_y32 = (sy32 += 1 << pixelcopy_t::FP_SCALE);
+      ++y;
+    } while (--h);
+  }
+
+  void Panel_DisplayList::readRect(std::uint_fast16_t, std::uint_fast16_t, std::uint_fast16_t w, std::uint_fast16_t h, void* dst, pixelcopy_t* param)
+  {
+    memset(dst, 0, (w * h * param->dst_bits + 7) >> 3);
+  }
+
+  void Panel_DisplayList::writeImageARGB(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, pixelcopy_t* param)
+  {
+    // the blending needs the pixels below, so the source row and the blending parameters are kept for the replay.
+    std::uint32_t sx = param->src_x32 >> pixelcopy_t::FP_SCALE;
+    std::uint32_t sy = param->src_y32 >> pixelcopy_t::FP_SCALE;
+    auto src = static_cast<const argb8888_t*>(param->src_data);
+    do
+    {
+      std::uint32_t offset = alloc_data(sizeof(pixelcopy_t) + w * sizeof(argb8888_t));
+      if (offset == ~0u) return;
+      memcpy(&_data[offset], param, sizeof(pixelcopy_t));
+      memcpy(&_data[offset + sizeof(pixelcopy_t)], &src[sx + sy * param->src_bitwidth], w * sizeof(argb8888_t));
+      add_cmd(display_list_cmd_t::image_argb, x, y, w, 1, offset);
+      ++sy;
+      ++y;
+    } while (--h);
+  }
+
+  void Panel_DisplayList::addImageRef(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, const std::uint8_t* data, std::uint32_t stride)
+  {
+    std::uint32_t offset = alloc_data(sizeof(display_list_ref_t));
+    if (offset == ~0u) return;
+    auto ref = reinterpret_cast<display_list_ref_t*>(&_data[offset]);
+    ref->data = data;
+    ref->stride = stride;
+    add_cmd(display_list_cmd_t::image_ref, x, y, w, h, offset);
+  }
+
+  void Panel_DisplayList::replay(void* dst, std::uint32_t dst_w, std::uint32_t dst_h, std::int32_t y0) const
+  {
+    std::uint32_t bytes = _write_bits >> 3;
+    std::int32_t y1 = y0 + dst_h;
+    auto buf = static_cast<std::uint8_t*>(dst);
+    auto cmd = _cmds;
+    for (std::uint32_t i = 0; i < _cmd_count; ++i, ++cmd)
+    {
+      std::int32_t top = std::max<std::int32_t>(cmd->y, y0);
+      std::int32_t bottom = std::min<std::int32_t>(cmd->y + cmd->h, y1);
+      if (top >= bottom || cmd->x >= dst_w) continue;
+      std::uint32_t w = std::min<std::uint32_t>(cmd->w, dst_w - cmd->x);
+      auto d = &buf[(cmd->x + (top - y0) * dst_w) * bytes];
+      std::int32_t rows = bottom - top;
+
+      switch (cmd->type)
+      {
+      case display_list_cmd_t::fill:
+        if (w == dst_w)
+        {
+          pixelcopy_t::fill_raw(d, cmd->value, bytes, w * rows);
+          break;
+        }
+        do
+        {
+          pixelcopy_t::fill_raw(d, cmd->value, bytes, w);
+          d += dst_w * bytes;
+        } while (--rows);
+        break;
+
+      case display_list_cmd_t::image:
+      case display_list_cmd_t::image_ref:
+        {
+          const std::uint8_t* s;
+          std::uint32_t stride = cmd->w * bytes;
+          if (cmd->type == display_list_cmd_t::image)
+          {
+            s = &_data[cmd->value];
+          }
+          else
+          {
+            auto ref = reinterpret_cast<const display_list_ref_t*>(&_data[cmd->value]);
+            s = ref->data;
+            stride = ref->stride;
+          }
+          s += (top - cmd->y) * stride;
+          do
+          {
+            memcpy(d, s, w * bytes);
+            d += dst_w * bytes;
+            s += stride;
+          } while (--rows);
+        }
+        break;
+
+      case display_list_cmd_t::image_argb:
+        {
+          pixelcopy_t p;
+          memcpy(&p, &_data[cmd->value], sizeof(pixelcopy_t));
+          p.src_data = &_data[cmd->value + sizeof(pixelcopy_t)];
+          p.src_x32 = 0;
+          p.src_y32 = 0;
+          p.src_x32_add = 1 << pixelcopy_t::FP_SCALE;
+          p.src_y32_add = 0;
+          p.src_bitwidth = cmd->w;
+          std::uint32_t pos = cmd->x + (top - y0) * dst_w;
+          p.fp_copy(buf, pos, pos + w, &p);
+        }
+        break;
+      }
+    }
+  }
+
+//----------------------------------------------------------------------------
+
+  void LGFX_DisplayList::createList(std::int32_t w, std::int32_t h)
+  {
+    _panel_list.setSize(w, h);
+    _sx = _sy = 0;
+    _sw = w;
+    _sh = h;
+    clearClipRect();
+  }
+
+  void LGFX_DisplayList::pushImageRef(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, const void* data)
+  {
+    std::uint32_t bytes = _write_conv.bytes;
+    std::uint32_t stride = w * bytes;
+    auto src = static_cast<const std::uint8_t*>(data);
+    // clipped now, so the replay only handles the strip boundaries.
+    if (x < _clip_l) { src += (_clip_l - x) * bytes; w -= _clip_l - x; x = _clip_l; }
+    if (y < _clip_t) { src += (_clip_t - y) * stride; h -= _clip_t - y; y = _clip_t; }
+    if (w > _clip_r - x + 1) { w = _clip_r - x + 1; }
+    if (h > _clip_b - y + 1) { h = _clip_b - y + 1; }
+    if (w < 1 || h < 1) return;
+    _panel_list.addImageRef(x, y, w, h, src, stride);
+  }
+
+  bool LGFX_DisplayList::renderStrip(LGFX_Sprite* strip, std::int32_t y0) const
+  {
+    auto buf = strip->getBuffer();
+    if (buf == nullptr || strip->getColorDepth() != _panel_list.getWriteDepth() || strip->getRotation() != 0) return false;
+    _panel_list.replay(buf, strip->width(), strip->height(), y0);
+    return true;
+  }
+
+  bool LGFX_DisplayList::render(LGFX_SwapChain* chain, std::int32_t x, std::int32_t y)
+  {
+    std::int32_t h = height();
+    std::int32_t y0 = 0;
+    do
+    {
+      auto strip = chain->acquire();
+      if (!renderStrip(strip, y0)) return false;
+      // the last strip may stick out of the list, only its upper part is sent.
+      chain->present(x, y + y0, h - y0);
+      y0 += strip->height();
+    } while (y0 < h);
+    return true;
+  }
+
+//----------------------------------------------------------------------------
+
+  std::uint_fast8_t LGFX_BandRenderer::begin(std::uint_fast8_t workers, std::int_fast8_t core)
+  {
+    end();
+    if (workers > max_workers) { workers = max_workers; }
+    while (_workers < workers)
+    {
+      auto task = startWorkerTask(core);
+      if (task == nullptr) break;
+      _tasks[_workers++] = task;
+    }
+    return _workers;
+  }
+
+  void LGFX_BandRenderer::end(void)
+  {
+    while (_workers)
+    {
+      stopWorkerTask(_tasks[--_workers]);
+      _tasks[_workers] = nullptr;
+    }
+  }
+
+  void LGFX_BandRenderer::band_task(void* arg)
+  {
+    auto band = static_cast<const band_t*>(arg);
+    band->list->replay(band->buffer, band->width, band->height, band->y0);
+  }
+
+  bool LGFX_BandRenderer::render(const LGFX_DisplayList* list, LGFX_Sprite* dst)
+  {
+    auto buf = static_cast<std::uint8_t*>(dst->getBuffer());
+    auto panel = &list->_panel_list;
+    if (buf == nullptr || dst->getColorDepth() != panel->getWriteDepth() || dst->getRotation() != 0) return false;
+
+    std::uint32_t w = dst->width();
+    std::uint32_t h = dst->height();
+    std::uint32_t stride = w * ((panel->getWriteDepth() & color_depth_t::bit_mask) >> 3);
+    std::uint_fast8_t count = std::min<std::uint32_t>(bands(), h);
+    std::uint32_t y = 0;
+    for (std::uint_fast8_t i = 0; i < count; ++i)
+    { // equal bands, the rows of a band are contiguous in the sprite buffer.
+      std::uint32_t next = h * (i + 1) / count;
+      auto band = &_bands[i];
+      band->list = panel;
+      band->buffer = &buf[y * stride];
+      band->width = w;
+      band->height = next - y;
+      band->y0 = y;
+      y = next;
+    }
+
+    // the last band is drawn by the caller while the tasks draw the others.
+    std::uint_fast8_t started = 0;
+    while (started + 1 < count && runWorkerTask(_tasks[started], band_task, &_bands[started])) { ++started; }
+    for (std::uint_fast8_t i = started; i < count; ++i) { band_task(&_bands[i]); }
+    for (std::uint_fast8_t i = 0; i < started; ++i) { waitWorkerTask(_tasks[i]); }
+    return true;
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -0,0 +1,241 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "LGFXBase.hpp"
+#include "LGFX_Sprite.hpp"
+#include "Panel.hpp"
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+  class LGFX_DisplayList;
+  class LGFX_BandRenderer;
+
+  struct display_list_cmd_t
+  {
+    enum type_t : std::uint8_t
+    { fill        // value : raw color
+    , image       // value : offset of the pixels (color depth of the list) in the data area
+    , image_ref   // value : offset of a display_list_ref_t in the data area
+    , image_argb  // value : offset of a pixelcopy_t followed by argb8888 pixels in the data area. h is always 1.
+    };
+    type_t type;
+    std::uint16_t x;
+    std::uint16_t y;
+    std::uint16_t w;
+    std::uint16_t h;
+    std::uint32_t value;
+  };
+
+  struct display_list_ref_t
+  {
+    const std::uint8_t* data;  // first pixel of the visible part
+    std::uint32_t stride;      // bytes per source row
+  };
+
+  /// Panel recording the drawing operations of LGFXBase as clipped rectangles, instead of drawing pixels.
+  /// Images are copied into the list in the color depth of the list, anti-aliased images keep their argb8888 pixels.
+  struct Panel_DisplayList : public IPanel
+  {
+    friend LGFX_DisplayList;
+
+    Panel_DisplayList(void) { _start_count = INT32_MAX; }
+    ~Panel_DisplayList(void) { release(); }
+
+    void beginTransaction(void) override {}
+    void endTransaction(void) override {}
+    void setInvert(bool invert) override {}
+    void setSleep(bool flg_sleep) override {}
+    void setPowerSave(bool flg_partial) override {}
+    void writeCommand(std::uint32_t cmd, std::uint_fast8_t length) override {}
+    void writeData(std::uint32_t data, std::uint_fast8_t length) override {}
+    void initDMA(void) override {}
+    void waitDMA(void) override {}
+    bool dmaBusy(void) override { return false; }
+    void waitDisplay(void) override {}
+    bool displayBusy(void) override { return false; }
+    void display(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h) override {}
+    bool isReadable(void) const override { return false; }
+    bool isBusShared(void) const override { return false; }
+
+    std::uint32_t readCommand(std::uint_fast8_t cmd, std::uint_fast8_t index = 0, std::uint_fast8_t length = 4) override { return 0; }
+    std::uint32_t readData(std::uint_fast8_t index = 0, std::uint_fast8_t length = 4) override { return 0; }
+
+    color_depth_t setColorDepth(color_depth_t depth) override;
+    void setRotation(std::uint_fast8_t r) override;
+
+    void setWindow(std::uint_fast16_t xs, std::uint_fast16_t ys, std::uint_fast16_t xe, std::uint_fast16_t ye) override;
+    void drawPixelPreclipped(std::uint_fast16_t x, std::uint_fast16_t y, std::uint32_t rawcolor) override;
+    void writeFillRectPreclipped(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, std::uint32_t rawcolor) override;
+    void writeBlock(std::uint32_t rawcolor, std::uint32_t len) override;
+    void writePixels(pixelcopy_t* param, std::uint32_t len) override;
+    void writeImage(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, pixelcopy_t* param, bool) override;
+    void writeImageARGB(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, pixelcopy_t* param) override;
+
+    /// the list holds no pixels, dst is filled with 0.
+    void readRect(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, void* dst, pixelcopy_t* param) override;
+    /// not recorded, the source pixels do not exist until the list is rendered.
+    void copyRect(std::uint_fast16_t dst_x, std::uint_fast16_t dst_y, std::uint_fast16_t w, std::uint_fast16_t h, std::uint_fast16_t src_x, std::uint_fast16_t src_y) override {}
+
+    void setSize(std::uint_fast16_t w, std::uint_fast16_t h);
+    void reset(void);
+    void release(void);
+
+    void addImageRef(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, const std::uint8_t* data, std::uint32_t stride);
+
+    /// Draw the rows y0 ~ y0+dst_h-1 of the list into dst (dst_w x dst_h pixels, color depth of the list, no rotation).
+    /// Only reads the list, so several buffers may be rendered at the same time.
+    /// リストの y0 ～ y0+dst_h-1 行を dst (dst_w x dst_h、リストと同じ色深度、回転なし) に描画する。
+    /// リストは読むだけなので、複数のバッファへ同時に描画してもよい
+    void replay(void* dst, std::uint32_t dst_w, std::uint32_t dst_h, std::int32_t y0) const;
+
+  protected:
+    display_list_cmd_t* _cmds = nullptr;
+    std::uint8_t* _data = nullptr;
+    std::uint32_t _cmd_count = 0;
+    std::uint32_t _cmd_capacity = 0;
+    std::uint32_t _data_len = 0;
+    std::uint32_t _data_capacity = 0;
+    std::uint_fast16_t _xpos = 0;
+    std::uint_fast16_t _ypos = 0;
+    bool _psram = false;
+    bool _overflow = false;
+
+    void add_cmd(display_list_cmd_t::type_t type, std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, std::uint32_t value);
+    std::uint32_t alloc_data(std::uint32_t len);
+    bool grow(void** buf, std::uint32_t* capacity, std::uint32_t need, std::uint32_t used);
+    void record_row(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, pixelcopy_t* param);
+  };
+
+//----------------------------------------------------------------------------
+
+  /// Records drawing instead of drawing, then renders the frame strip by strip into small sprites.
+  /// A full frame is built without a full-screen buffer, e.g. 320x240 with two 320x24 strips (about 10% of the memory).
+  /// The color depth must be a byte depth (8 / 16 / 24bit) and equal to the strips. Reading pixels and copyRect are not supported.
+  /// 描画内容を記録し、小さなスプライト(ストリップ)単位でフレームを描画する。
+  /// 全画面バッファなしでフレームを構築できる(例:320x240を320x24のストリップ2枚、メモリ約10%)。
+  /// 色深度は8 / 16 / 24bitで、ストリップと同じであること。ピクセルの読出しとcopyRectは非対応
+  class LGFX_DisplayList : public LovyanGFX
+  {
+    friend LGFX_BandRenderer;
+  public:
+    LGFX_DisplayList(void)
+    {
+      _panel = &_panel_list;
+      setColorDepth(rgb565_2Byte);
+    }
+
+    LGFX_DisplayList(const LGFX_DisplayList&) = delete;
+    LGFX_DisplayList& operator=(const LGFX_DisplayList&) = delete;
+
+    void setPsram(bool enabled) { _panel_list._psram = enabled; }
+
+    /// Set the size of the frame and clear the list.
+    void createList(std::int32_t w, std::int32_t h);
+
+    /// Drop the recorded commands, the memory is kept for the next frame.
+    void resetList(void) { _panel_list.reset(); }
+
+    /// Free the memory of the list.
+    void deleteList(void) { _panel_list.release(); }
+
+    /// Record an image by reference, the pixels are read when the list is rendered and must stay valid until then.
+    /// data is in the color depth of the list (same layout as a sprite buffer).
+    /// 画像を参照として記録する。ピクセルは描画時に読まれるため、それまで有効であること。dataはリストと同じ色深度(スプライトバッファと同じ形式)
+    void pushImageRef(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, const void* data);
+
+    /// Draw the list rows y0 ~ y0+height-1 into strip. The strip must have the color depth of the list and no rotation.
+    bool renderStrip(LGFX_Sprite* strip, std::int32_t y0) const;
+
+    /// Render the whole frame with the sprites of chain as strips, each strip is sent while the next one is drawn.
+    /// The chain must be created with the width of the list, the height of its sprites is the strip height.
+    /// chainのスプライトをストリップとしてフレーム全体を描画する。各ストリップは次のストリップの描画中に送信される。
+    /// chainはリストの幅で作成すること。スプライトの高さがストリップの高さとなる
+    bool render(LGFX_SwapChain* chain, std::int32_t x = 0, std::int32_t y = 0);
+
+    std::uint32_t commandCount(void) const { return _panel_list._cmd_count; }
+    std::uint32_t dataLength(void) const { return _panel_list._data_len; }
+    /// bytes allocated for the commands and the data.
+    std::size_t memoryUsage(void) const { return _panel_list._cmd_capacity * sizeof(display_list_cmd_t) + _panel_list._data_capacity; }
+    /// false : some commands were dropped because no memory was available.
+    bool isValid(void) const { return !_panel_list._overflow; }
+
+  protected:
+    Panel_DisplayList _panel_list;
+  };
+
+//----------------------------------------------------------------------------
+
+  /// Renders a display list into a large sprite with several tasks, the sprite is split into horizontal bands.
+  /// Each band is drawn by one task, the tasks only read the list and write the pixels of their own band.
+  /// On platforms without worker tasks every band is drawn by the caller.
+  /// ディスプレイリストを複数のタスクで大きなスプライトに描画する。スプライトは水平の帯に分割される。
+  /// 各帯は1つのタスクが描画し、タスクはリストを読んで自分の帯のピクセルのみ書き込む。
+  /// ワーカータスクのないプラットフォームでは全ての帯を呼出し元が描画する
+  class LGFX_BandRenderer
+  {
+  public:
+    enum : std::uint8_t { max_workers = 3 };
+
+    LGFX_BandRenderer(void) = default;
+    LGFX_BandRenderer(const LGFX_BandRenderer&) = delete;
+    LGFX_BandRenderer& operator=(const LGFX_BandRenderer&) = delete;
+    ~LGFX_BandRenderer(void) { end(); }
+
+    /// Start the worker tasks, the caller draws one more band. Returns the number of tasks started.
+    /// core : -1 no affinity, otherwise the tasks are pinned to this core (e.g. the other core of ESP32).
+    /// ワーカータスクを開始する。呼出し元も1つの帯を描画する。開始したタスク数を返す。
+    /// core : -1 指定なし、それ以外はタスクをこのコアに固定する(例:ESP32の呼出し元と別のコア)
+    std::uint_fast8_t begin(std::uint_fast8_t workers = 1, std::int_fast8_t core = -1);
+
+    /// Stop the worker tasks.
+    void end(void);
+
+    /// Number of bands drawn at the same time (worker tasks + caller).
+    std::uint_fast8_t bands(void) const { return _workers + 1; }
+
+    /// Draw the whole list into dst and return when all bands are done.
+    /// dst must have the color depth of the list and no rotation.
+    bool render(const LGFX_DisplayList* list, LGFX_Sprite* dst);
+
+  private:
+    struct band_t
+    {
+      const Panel_DisplayList* list;
+      std::uint8_t* buffer;
+      std::uint32_t width;
+      std::uint32_t height;
+      std::int32_t y0;
+    };
+
+    static void band_task(void* arg);
+
+    void* _tasks[max_workers] = { nullptr, };
+    band_t _bands[max_workers + 1];
+    std::uint8_t _workers = 0;
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
+
+using LGFX_DisplayList = lgfx::LGFX_DisplayList;
+using LGFX_BandRenderer = lgfx::LGFX_BandRenderer;
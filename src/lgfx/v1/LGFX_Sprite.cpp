@@ -81,7 +81,7 @@ namespace lgfx
     _img.release();
   }
 
-  void* Panel_Sprite::createSprite(std::int32_t w, std::int32_t h, color_conv_t* conv, bool psram)
+  void* Panel_Sprite::createSprite(std::int32_t w, std::int32_t h, color_conv_t* conv, bool psram, SpritePool* pool)
   {
     if (w < 1 || h < 1)
     {
@@ -95,7 +95,8 @@ namespace lgfx
       _bitwidth = (w + conv->x_mask) & (~(std::uint32_t)conv->x_mask);
       std::size_t len = h * (_bitwidth * _write_bits >> 3) + 1;
 
-      _img.reset(len, psram ? AllocationSource::Psram : AllocationSource::Dma);
+      if (pool) { _img.reset(len, pool); }
+      else { _img.reset(len, psram ? AllocationSource::Psram : AllocationSource::Dma); }
 
       if (!_img)
       {
@@ -439,11 +440,32 @@ namespace lgfx
     _ypos = y;
   }
 
+  static void memcpy_direct(std::uint8_t* dst, const std::uint8_t* src, std::size_t len)
+  {
+    memcpy(dst, src, len);
+  }
+
+  /// memcpy between PSRAM areas is avoided, the data passes through a buffer in internal RAM.
+  static void memcpy_bounce(std::uint8_t* dst, const std::uint8_t* src, std::size_t len)
+  {
+    std::uint8_t buf[256];
+    while (len)
+    {
+      std::size_t n = std::min(len, sizeof(buf));
+      memcpy(buf, src, n);
+      memcpy(dst, buf, n);
+      src += n;
+      dst += n;
+      len -= n;
+    }
+  }
+
   void Panel_Sprite::writeImage(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, pixelcopy_t* param, bool)
   {
     std::uint_fast8_t r = _rotation;
-    if (r == 0 && param->transp == pixelcopy_t::NON_TRANSP && param->no_convert && _img.use_memcpy())
+    if (r == 0 && param->transp == pixelcopy_t::NON_TRANSP && param->no_convert)
     {
+      auto copy = _img.use_memcpy() ? memcpy_direct : memcpy_bounce;
       auto sx = param->src_x;
       auto bits = param->src_bits;
       std::uint_fast8_t mask = (bits == 1) ? 7
@@ -457,7 +479,7 @@ namespace lgfx
         auto src = &((std::uint8_t*)param->src_data)[param->src_y * sw];
         if (sw == bw && this->_panel_width == w && sx == 0 && x == 0)
         {
-          memcpy(dst, src, bw * h);
+          copy(dst, src, bw * h);
           return;
         }
         y = 0;
@@ -466,7 +488,7 @@ namespace lgfx
         w    =  w * bits >> 3;
         do
         {
-          memcpy(&dst[y * bw], &src[y * sw], w);
+          copy(&dst[y * bw], &src[y * sw], w);
         } while (++y != h);
         return;
       }
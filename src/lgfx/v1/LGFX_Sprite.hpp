@@ -60,7 +60,7 @@ namespace lgfx
 
     void setBuffer(void* buffer, std::int32_t w, std::int32_t h, color_conv_t* conv);
     void deleteSprite(void);
-    void* createSprite(std::int32_t w, std::int32_t h, color_conv_t* conv, bool psram);
+    void* createSprite(std::int32_t w, std::int32_t h, color_conv_t* conv, bool psram, SpritePool* pool = nullptr);
 
     __attribute__ ((always_inline)) inline void* getBuffer(void) const { return _img.get(); }
     __attribute__ ((always_inline)) inline const SpriteBuffer* getSpriteBuffer(void) const { return &_img; }
@@ -143,6 +143,13 @@ namespace lgfx
       _psram = enabled;
     }
 
+    /// Take the buffer of the following createSprite calls from a SpritePool instead of the heap. nullptr : heap.
+    /// 以降のcreateSpriteでバッファをヒープではなくSpritePoolから確保する。nullptrでヒープに戻す
+    void setSpritePool( SpritePool* pool )
+    {
+      _pool = pool;
+    }
+
     void setBuffer(void* buffer, std::int32_t w, std::int32_t h, std::uint8_t bpp = 0)
     {
       deleteSprite();
@@ -163,7 +170,7 @@ namespace lgfx
 
     void* createSprite(std::int32_t w, std::int32_t h)
     {
-      _img = _panel_sprite.createSprite(w, h, &_write_conv, _psram);
+      _img = _panel_sprite.createSprite(w, h, &_write_conv, _psram, _pool);
       if (_img) {
         if (!_palette && 0 == _write_conv.bytes)
         {
@@ -399,6 +406,7 @@ namespace lgfx
 //    std::int32_t _bitwidth;
 
     bool _psram = false;
+    SpritePool* _pool = nullptr;
 
     bool create_palette(void)
     {
@@ -466,12 +474,10 @@ namespace lgfx
       std::size_t buffersize = ((w * bpp + 31) >> 5) << 2;  // readline 4Byte align.
       std::uint8_t lineBuffer[buffersize];  // readline 4Byte align.
       if (bpp <= 8) {
+        bitmap_rle_decoder_t rle_decoder(data, bpp, bmpdata.biSizeImage);
         do {
-          if (bmpdata.biCompression == 1) {
-            bmpdata.load_bmp_rle8(data, lineBuffer, w);
-          } else
-          if (bmpdata.biCompression == 2) {
-            bmpdata.load_bmp_rle4(data, lineBuffer, w);
+          if (bmpdata.biCompression == 1 || bmpdata.biCompression == 2) {
+            rle_decoder.decodeLine(lineBuffer, w);
           } else {
             data->read(lineBuffer, buffersize);
           }
@@ -543,8 +549,137 @@ namespace lgfx
 
   };
 
+//----------------------------------------------------------------------------
+
+  /// Sprites presented to a device in turn (swap chain). present() starts the DMA transfer of the back buffer and returns at once,
+  /// so the next frame is drawn while the previous one is sent. acquire() blocks only when the buffer is still being transferred.
+  /// The bus transaction is held from the first present() until end(), other devices on the bus must wait until then.
+  /// 複数のスプライトを順にデバイスへ送るスワップチェーン。present()はバックバッファのDMA転送を開始してすぐに戻るため、
+  /// 前のフレームの送信中に次のフレームを描画できる。acquire()は、そのバッファが転送中の場合のみ待機する。
+  /// 最初のpresent()からend()までバスのトランザクションを保持するため、同じバスの他のデバイスはそれまで待つ必要がある
+  class LGFX_SwapChain
+  {
+  public:
+    enum : std::uint8_t { max_buffers = 3 };
+
+    LGFX_SwapChain(LGFX_Device* dst) : _dst { dst } {}
+    LGFX_SwapChain(const LGFX_SwapChain&) = delete;
+    LGFX_SwapChain& operator=(const LGFX_SwapChain&) = delete;
+    ~LGFX_SwapChain(void) { release(); }
+
+    /// count : number of buffers (2 ~ max_buffers). The buffers use the color depth of the device, so they are sent without conversion.
+    bool create(std::int32_t w, std::int32_t h, std::uint_fast8_t count = 2)
+    {
+      release();
+      if (count < 2) { count = 2; }
+      if (count > max_buffers) { count = max_buffers; }
+      for (std::uint_fast8_t i = 0; i < count; ++i)
+      {
+        auto s = &_sprites[i];
+        s->setPsram(false);
+        s->setColorDepth(_dst->getColorDepth());
+        if (!s->createSprite(w, h))
+        {
+          release();
+          return false;
+        }
+      }
+      _count = count;
+      return true;
+    }
+
+    void release(void)
+    {
+      end();
+      for (std::uint_fast8_t i = 0; i < max_buffers; ++i) { _sprites[i].deleteSprite(); }
+      _count = 0;
+      _back = 0;
+      _in_flight = -1;
+    }
+
+    /// Wait for the last transfer and release the bus transaction.
+    void end(void)
+    {
+      if (!_active) return;
+      _dst->waitDMA();
+      _dst->endWrite();
+      _active = false;
+      _in_flight = -1;
+    }
+
+    /// The buffer to draw the next frame into.
+    LGFX_Sprite* acquire(void)
+    {
+      if (_back == _in_flight) { wait(_frame); }
+      return &_sprites[_back];
+    }
+
+    /// Start sending the back buffer to (x, y) of the device and move to the next buffer. Returns the fence of the frame.
+    /// rows : only the upper rows of the buffer are sent. -1 : all rows.
+    std::uint32_t present(std::int32_t x = 0, std::int32_t y = 0, std::int32_t rows = -1)
+    {
+      if (_count == 0) return _frame;
+      if (!_active)
+      {
+        _dst->startWrite();
+        _active = true;
+      }
+      auto s = &_sprites[_back];
+      // within the held transaction pushSprite returns while the DMA is running.
+      if (rows < 0 || rows >= s->height())
+      {
+        s->pushSprite(_dst, x, y);
+      }
+      else
+      {
+        std::int32_t cx, cy, cw, ch;
+        _dst->getClipRect(&cx, &cy, &cw, &ch);
+        std::int32_t b = std::min(cy + ch, y + rows);
+        std::int32_t t = std::max(cy, y);
+        if (t < b)
+        {
+          _dst->setClipRect(cx, t, cw, b - t);
+          s->pushSprite(_dst, x, y);
+          _dst->setClipRect(cx, cy, cw, ch);
+        }
+      }
+      _in_flight = _back;
+      if (++_back == _count) { _back = 0; }
+      return ++_frame;
+    }
+
+    /// true : the transfer of the frame has finished. A frame is finished once a later one has been started, the bus sends them in order.
+    bool isComplete(std::uint32_t fence)
+    {
+      if (fence < _frame || _in_flight < 0) { return true; }
+      if (_dst->dmaBusy()) { return false; }
+      _in_flight = -1;
+      return true;
+    }
+
+    void wait(std::uint32_t fence)
+    {
+      if (isComplete(fence)) return;
+      _dst->waitDMA();
+      _in_flight = -1;
+    }
+
+    std::uint_fast8_t count(void) const { return _count; }
+    std::uint32_t frame(void) const { return _frame; }
+
+  private:
+    LGFX_Device* _dst;
+    LGFX_Sprite _sprites[max_buffers];
+    std::uint32_t _frame = 0;
+    std::int_fast8_t _in_flight = -1;
+    std::uint_fast8_t _count = 0;
+    std::uint_fast8_t _back = 0;
+    bool _active = false;
+  };
+
 //----------------------------------------------------------------------------
  }
 }
 
 using LGFX_Sprite = lgfx::LGFX_Sprite;
+using LGFX_SwapChain = lgfx::LGFX_SwapChain;
@@ -17,6 +17,8 @@ Contributors:
 /----------------------------------------------------------------------------*/
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 
 namespace lgfx
@@ -33,6 +35,62 @@ namespace lgfx
     std::uint16_t size = 0;
   };
 
+  enum touch_state_t : std::uint8_t
+  {
+    touch_none  = 0,
+    touch_begin = 1,  /// 指が触れた
+    touch_move  = 2,  /// 触れたまま座標が変化した
+    touch_end   = 3,  /// 指が離れた
+  };
+
+  struct touch_event_t
+  {
+    std::int32_t x = -1;
+    std::int32_t y = -1;
+    std::uint32_t msec = 0;
+    std::uint16_t size = 0;
+    std::uint8_t id = 0;
+    touch_state_t state = touch_none;
+  };
+
+  /// Single-producer / single-consumer lock-free ring buffer for touch events.
+  /// Events pushed while the queue is full are dropped.
+  /// タッチイベント用のロックフリーリングバッファ (書込み側・読出し側それぞれ1タスクまで)
+  /// キューが満杯の時に追加されたイベントは破棄される
+  template <std::size_t N>
+  class TouchEventQueue
+  {
+    static_assert((N & (N - 1)) == 0, "N must be a power of 2");
+  public:
+    bool push(const touch_event_t& ev)
+    {
+      auto head = _head.load(std::memory_order_relaxed);
+      if (head - _tail.load(std::memory_order_acquire) >= N) return false;
+      _buf[head & (N - 1)] = ev;
+      _head.store(head + 1, std::memory_order_release);
+      return true;
+    }
+
+    bool pop(touch_event_t* ev)
+    {
+      auto tail = _tail.load(std::memory_order_relaxed);
+      if (tail == _head.load(std::memory_order_acquire)) return false;
+      *ev = _buf[tail & (N - 1)];
+      _tail.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    std::size_t size(void) const { return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire); }
+
+    /// Call from the consumer side only. 読出し側からのみ呼び出すこと
+    void clear(void) { _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release); }
+
+  private:
+    touch_event_t _buf[N];
+    std::atomic<std::uint32_t> _head { 0 };
+    std::atomic<std::uint32_t> _tail { 0 };
+  };
+
 //----------------------------------------------------------------------------
 
   struct ITouch
@@ -943,8 +943,9 @@ namespace lgfx
     std::int32_t yoffset = (this->maxAscent - dY);
 //      std::int32_t yoffset = (gfx->_font_metrics.y_offset) - dY;
 
-    std::uint8_t pbuffer[w * h];
-    std::uint8_t* pixel = pbuffer;
+    ScratchArena::checkpoint_t cp(gfx->getScratchArena());
+    auto pixel = gfx->getScratchArena()->allocate_array<std::uint8_t>(w * h);
+    if (pixel == nullptr) { return xAdvance; }
     if (gNum != 0xFFFF) {
       file->read(pixel, w * h);
       file->postRead();
@@ -94,6 +94,31 @@ namespace lgfx
     std::uint32_t _length = 0;
   };
 
+//----------------------------------------------------------------------------
+
+  /// Output sink for streaming encoders (e.g. writePng). write must consume all bytes or return false.
+  /// ストリーム出力先 (writePng等で使用)。writeは全データを書き込むか、失敗時にfalseを返すこと
+  struct DataWriter
+  {
+    virtual ~DataWriter(void) = default;
+    virtual bool write(const std::uint8_t* buf, std::uint32_t len) = 0;
+  };
+
+#if defined (Print_h)
+
+  /// DataWriter for Arduino Print (Serial, File, etc.)
+  struct PrintWriter : public DataWriter
+  {
+    PrintWriter(Print* print = nullptr) : _print(print) {}
+    void set(Print* print) { _print = print; }
+    bool write(const std::uint8_t* buf, std::uint32_t len) override { return _print && _print->write(buf, len) == len; }
+
+  private:
+    Print* _print;
+  };
+
+#endif
+
 //----------------------------------------------------------------------------
 
 #if defined (SdFat_h)
@@ -36,6 +36,250 @@ namespace lgfx
     Dma,
     Psram,
     Preallocated,
+    Pool,
+  };
+
+  /// Region reserved once, from which sprite buffers are sub-allocated. Creating and deleting sprites then no longer fragments the heap.
+  /// Free blocks are kept in lists per size class (4 classes per power of two) and merged with their neighbours when released.
+  /// Not thread safe. All sprites using the pool must be deleted before the pool is released.
+  /// 一度だけ確保した領域からスプライトのバッファを切り出すプール。スプライトの生成・削除でヒープが断片化しなくなる。
+  /// 空きブロックはサイズクラス毎(2の冪毎に4クラス)のリストで管理し、解放時に隣接ブロックと結合する。
+  /// スレッドセーフではない。プールを解放する前に、プールを使用するスプライトを全て削除すること
+  class SpritePool
+  {
+  public:
+    struct stats_t
+    {
+      std::size_t capacity;       // bytes of the region
+      std::size_t used;           // bytes of the allocated blocks, headers included
+      std::size_t high_water;     // maximum of used since reserve()
+      std::size_t free_total;     // capacity - used
+      std::size_t free_largest;   // largest length allocate() can satisfy now
+      std::uint32_t allocations;  // live blocks
+      std::uint32_t failures;     // allocate() calls that returned nullptr
+      std::uint8_t fragmentation; // 0~100 : share of the free memory outside the largest free block
+    };
+
+    SpritePool(void) = default;
+    SpritePool(const SpritePool&) = delete;
+    SpritePool& operator=(const SpritePool&) = delete;
+    ~SpritePool(void) { release(); }
+
+    /// Reserve the region from the heap. Psram falls back to Dma when no PSRAM is available.
+    bool reserve(std::size_t length, AllocationSource source = AllocationSource::Dma)
+    {
+      release();
+      void* buffer = nullptr;
+      switch (source)
+      {
+        default:
+          source = AllocationSource::Normal;
+          buffer = heap_alloc(length);
+          break;
+        case AllocationSource::Dma:
+          buffer = heap_alloc_dma(length);
+          break;
+        case AllocationSource::Psram:
+          buffer = heap_alloc_psram(length);
+          if (!buffer)
+          {
+            source = AllocationSource::Dma;
+            buffer = heap_alloc_dma(length);
+          }
+          break;
+      }
+      if (buffer == nullptr) { return false; }
+      setup(buffer, length, source);
+      _owned = true;
+      return true;
+    }
+
+    /// Use a region supplied by the caller (e.g. a static array). source tells what kind of memory it is.
+    bool reserve(void* buffer, std::size_t length, AllocationSource source = AllocationSource::Dma)
+    {
+      release();
+      if (buffer == nullptr) { return false; }
+      setup(buffer, length, source);
+      return _base != nullptr;
+    }
+
+    void release(void)
+    {
+      if (_owned && _region) { heap_free(_region); }
+      _region = nullptr;
+      _base = nullptr;
+      _owned = false;
+      _size = 0;
+    }
+
+    bool isReserved(void) const { return _base != nullptr; }
+    AllocationSource source(void) const { return _source; }
+
+    void* allocate(std::size_t length)
+    {
+      if (_base == nullptr || length == 0 || length > _size) { ++_failures; return nullptr; }
+      std::uint32_t need = (length + sizeof(block_t) + granule - 1) & ~(granule - 1);
+      std::uint32_t cls = size_class(need / granule);
+
+      // first fit inside the own class, then any block of a larger class is large enough.
+      std::uint32_t off = nil;
+      for (auto o = _free[cls]; o != nil; o = blk(o)->next_free)
+      {
+        if (blk(o)->size >= need) { off = o; break; }
+      }
+      for (auto c = cls + 1; off == nil && c < class_count; ++c) { off = _free[c]; }
+      if (off == nil) { ++_failures; return nullptr; }
+
+      unlink(off);
+      auto b = blk(off);
+      std::uint32_t size = b->size;
+      if (size - need >= granule * 2)
+      { // split, the rest stays free.
+        b->size = need;
+        std::uint32_t rest = off + need;
+        blk(rest)->size = size - need;
+        blk(rest)->prev_size = need;
+        std::uint32_t next = off + size;
+        if (next < _size) { blk(next)->prev_size = size - need; }
+        insert(rest);
+        size = need;
+      }
+      b->size = size | used_flag;
+      _used += size;
+      if (_high_water < _used) { _high_water = _used; }
+      ++_count;
+      return &_base[off + sizeof(block_t)];
+    }
+
+    void deallocate(void* ptr)
+    {
+      if (!contains(ptr)) { return; }
+      std::uint32_t off = static_cast<std::uint8_t*>(ptr) - _base - sizeof(block_t);
+      auto b = blk(off);
+      if (!(b->size & used_flag)) { return; }
+      std::uint32_t size = b->size & ~used_flag;
+      _used -= size;
+      --_count;
+
+      std::uint32_t next = off + size;
+      if (next < _size && !(blk(next)->size & used_flag))
+      {
+        unlink(next);
+        size += blk(next)->size;
+      }
+      if (b->prev_size)
+      {
+        std::uint32_t prev = off - b->prev_size;
+        if (!(blk(prev)->size & used_flag))
+        {
+          unlink(prev);
+          size += blk(prev)->size;
+          off = prev;
+        }
+      }
+      blk(off)->size = size;
+      next = off + size;
+      if (next < _size) { blk(next)->prev_size = size; }
+      insert(off);
+    }
+
+    bool contains(const void* ptr) const
+    {
+      auto p = static_cast<const std::uint8_t*>(ptr);
+      return _base && p >= _base + sizeof(block_t) && p < _base + _size;
+    }
+
+    void getStats(stats_t* st) const
+    {
+      std::uint32_t largest = 0;
+      for (auto c = class_count; c-- && !largest; )
+      {
+        for (auto o = _free[c]; o != nil; o = blk(o)->next_free)
+        {
+          if (largest < blk(o)->size) { largest = blk(o)->size; }
+        }
+      }
+      st->capacity     = _size;
+      st->used         = _used;
+      st->high_water   = _high_water;
+      st->free_total   = _size - _used;
+      st->free_largest = largest ? largest - sizeof(block_t) : 0;
+      st->allocations  = _count;
+      st->failures     = _failures;
+      st->fragmentation = st->free_total ? 100 - (std::uint64_t)largest * 100 / st->free_total : 0;
+    }
+
+  private:
+    /// header in front of every block. The free list links are only meaningful while the block is free.
+    struct block_t
+    {
+      std::uint32_t size;       // bytes including this header. bit0 : in use
+      std::uint32_t prev_size;  // size of the block just before in memory. 0 : first block
+      std::uint32_t next_free;  // offsets from _base
+      std::uint32_t prev_free;
+    };
+
+    static constexpr std::uint32_t granule = 32;
+    static constexpr std::uint32_t used_flag = 1;
+    static constexpr std::uint32_t nil = ~0u;
+    static constexpr std::uint32_t class_count = 112;
+
+    std::uint8_t* _region = nullptr;
+    std::uint8_t* _base = nullptr;
+    std::uint32_t _size = 0;
+    std::uint32_t _used = 0;
+    std::uint32_t _high_water = 0;
+    std::uint32_t _count = 0;
+    std::uint32_t _failures = 0;
+    std::uint32_t _free[class_count];
+    AllocationSource _source = AllocationSource::Dma;
+    bool _owned = false;
+
+    block_t* blk(std::uint32_t off) const { return reinterpret_cast<block_t*>(&_base[off]); }
+
+    /// size class of a block of n granules. exact below 4, then 4 classes per power of two.
+    static std::uint32_t size_class(std::uint32_t n)
+    {
+      if (n < 4) { return n; }
+      std::uint32_t msb = 31 - __builtin_clz(n);
+      return (msb << 2) | ((n >> (msb - 2)) & 3);
+    }
+
+    void setup(void* buffer, std::size_t length, AllocationSource source)
+    {
+      _region = static_cast<std::uint8_t*>(buffer);
+      std::uintptr_t adr = reinterpret_cast<std::uintptr_t>(buffer);
+      std::uintptr_t aligned = (adr + 15) & ~(std::uintptr_t)15;
+      length -= std::min<std::size_t>(length, aligned - adr);
+      if (length > (std::size_t)1 << 31) { length = (std::size_t)1 << 31; }
+      _size = length & ~(std::size_t)(granule - 1);
+      _used = _high_water = _count = _failures = 0;
+      _source = source;
+      for (auto& f : _free) { f = nil; }
+      if (_size < granule * 2) { _base = nullptr; return; }
+      _base = reinterpret_cast<std::uint8_t*>(aligned);
+      blk(0)->size = _size;
+      blk(0)->prev_size = 0;
+      insert(0);
+    }
+
+    void insert(std::uint32_t off)
+    {
+      auto b = blk(off);
+      auto& head = _free[size_class(b->size / granule)];
+      b->prev_free = nil;
+      b->next_free = head;
+      if (head != nil) { blk(head)->prev_free = off; }
+      head = off;
+    }
+
+    void unlink(std::uint32_t off)
+    {
+      auto b = blk(off);
+      if (b->prev_free != nil) { blk(b->prev_free)->next_free = b->next_free; }
+      else { _free[size_class(b->size / granule)] = b->next_free; }
+      if (b->next_free != nil) { blk(b->next_free)->prev_free = b->prev_free; }
+    }
   };
 
   class SpriteBuffer
@@ -44,6 +288,13 @@ namespace lgfx
     std::uint8_t* _buffer;
     std::size_t _length;
     AllocationSource _source;
+    SpritePool* _pool = nullptr;
+
+    void reset_as(const SpriteBuffer& rhs)
+    {
+      if (rhs._source == AllocationSource::Pool) { this->reset(rhs._length, rhs._pool); }
+      else { this->reset(rhs._length, rhs._source); }
+    }
 
   public:
     SpriteBuffer(void) : _buffer(nullptr), _length(0), _source(Dma) {}
@@ -71,7 +322,7 @@ namespace lgfx
       }
       else
       {
-        this->reset(rhs._length, rhs._source);
+        this->reset_as(rhs);
         if( _buffer != nullptr && rhs._buffer != nullptr )
         {
           std::copy(rhs._buffer, rhs._buffer + _length, _buffer);
@@ -87,7 +338,7 @@ namespace lgfx
         this->_source = rhs._source;
       }
       else {
-        this->reset(rhs._length, rhs._source);
+        this->reset_as(rhs);
         if( _buffer != nullptr && rhs._buffer != nullptr ) {
           std::copy(rhs._buffer, rhs._buffer + _length, _buffer);
           rhs.release();
@@ -103,7 +354,7 @@ namespace lgfx
         this->_source = rhs._source;
       }
       else {
-        this->reset(rhs._length, rhs._source);
+        this->reset_as(rhs);
         if ( _buffer != nullptr && rhs._buffer != nullptr ) {
           std::copy(rhs._buffer, rhs._buffer + _length, _buffer);
         }
@@ -119,7 +370,7 @@ namespace lgfx
         this->_source = rhs._source;
       }
       else {
-        this->reset(rhs._length, rhs._source);
+        this->reset_as(rhs);
         if( _buffer != nullptr && rhs._buffer != nullptr ) {
           std::copy(rhs._buffer, rhs._buffer + _length, _buffer);
           rhs.release();
@@ -173,16 +424,30 @@ namespace lgfx
       }
     }
 
+    /// sub-allocate from a SpritePool. Fails (no heap fallback) when the pool has no room.
+    void reset(std::size_t length, SpritePool* pool)
+    {
+      this->release();
+      _source = AllocationSource::Pool;
+      _pool = pool;
+      _buffer = pool ? reinterpret_cast<std::uint8_t*>(pool->allocate(length)) : nullptr;
+      if ( _buffer != nullptr ) {
+        _length = length;
+      }
+    }
+
     void release() {
       _length = 0;
       if ( _buffer != nullptr ) {
-        heap_free(_buffer);
+        if (_source == AllocationSource::Pool) { _pool->deallocate(_buffer); }
+        else if (_source != AllocationSource::Preallocated) { heap_free(_buffer); }
         _buffer = nullptr;
       }
     }
 
-    bool use_dma() const { return _source == AllocationSource::Dma; }
-    bool use_memcpy() const { return _source != AllocationSource::Psram; }
+    AllocationSource memory_source() const { return (_source == AllocationSource::Pool) ? _pool->source() : _source; }
+    bool use_dma() const { return memory_source() == AllocationSource::Dma; }
+    bool use_memcpy() const { return memory_source() != AllocationSource::Psram; }
   };
 
 //----------------------------------------------------------------------------
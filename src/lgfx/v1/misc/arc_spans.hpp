@@ -0,0 +1,364 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "range.hpp"
+#include "../platforms/common.hpp"
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// Span generator for (elliptical) arcs. sin/cos are evaluated once per angle, each row is produced with integer arithmetic only.
+  /// The ring is tracked incrementally from row to row, the start/end angles clip it through integer cross products.
+  /// 円弧(楕円弧)のスパン生成器。三角関数は角度ごとに1回だけ使い、各行は整数演算のみで求める。
+  /// リングは前の行から差分で追跡し、開始・終了角は整数の外積で切り取る
+  struct arc_span_generator_t
+  {
+    static constexpr std::size_t max_spans = 4;
+
+    /// @param r0x,r0y outer radius
+    /// @param r1x,r1y inner radius (r1 <= r0)
+    /// @param start,end angle in degree, normalized to [0, 360). end == start + 360 : full ring. end == start : radial line.
+    arc_span_generator_t(std::int32_t r0x, std::int32_t r1x, std::int32_t r0y, std::int32_t r1y, float start, float end)
+    : _r0x { r0x }, _r1x { r1x }, _r0y { r0y }, _r1y { r1y }
+    , _circle { r0x == r0y && r1x == r1y }
+    {
+      _o2x = r0x * (r0x + 1);
+      _o2y = r0y * (r0y + 1);
+      _i2x = r1x * (r1x - 1);
+      _i2y = r1y * (r1y - 1);
+      _xo = r0x;
+
+      float sweep = end - start;
+      if (sweep < 0) { sweep += 360; }
+      if (sweep >= 360) { _mode = mode_full; return; }
+
+      static constexpr float deg_to_rad = 0.017453292519943295769236907684886;
+      _sx = lroundf(cosf(start * deg_to_rad) * one);
+      _sy = lroundf(sinf(start * deg_to_rad) * one);
+      _ex = lroundf(cosf(end   * deg_to_rad) * one);
+      _ey = lroundf(sinf(end   * deg_to_rad) * one);
+      _mode = (sweep > 180) ? mode_union
+            : (sweep <  90) ? mode_narrow
+                            : mode_wedge;
+    }
+
+    /// Get the spans of row y (relative to the center, x is also relative). Consecutive rows are cheapest.
+    /// y行目(中心からの相対)のスパンを取得する。連続した行を順に取得すると最も軽い
+    /// @return number of spans (0 ～ max_spans), sorted from left to right.
+    std::size_t getRow(std::int32_t y, range_t* spans)
+    {
+      range_t ring[2];
+      std::size_t rn = ring_row(y, ring);
+      if (rn == 0 || _mode == mode_full)
+      {
+        for (std::size_t i = 0; i < rn; ++i) { spans[i] = ring[i]; }
+        return rn;
+      }
+
+      // half planes with a half pixel tolerance measured along the major axis, so that a radial line is as thick as a Bresenham line.
+      // 主軸方向に半画素の許容幅を持たせた半平面。径方向の線がBresenhamの線と同じ太さになる
+      range_t ang[2];
+      std::size_t an = 1;
+      auto h1 = halfplane(-2 * _sy, -2 * _sx * y - tolerance(_sx, _sy));
+      auto h2 = halfplane( 2 * _ey,  2 * _ex * y - tolerance(_ex, _ey));
+      if (_mode == mode_union)
+      {
+        ang[0] = h1;
+        ang[1] = h2;
+        an = 2;
+      }
+      else
+      {
+        ang[0] = intersect(h1, h2);
+        if (_mode == mode_narrow)
+        { // cut off the opposite wedge that the tolerance lets through.
+          std::int32_t mx = _sx + _ex;
+          std::int32_t my = _sy + _ey;
+          ang[0] = intersect(ang[0], halfplane(2 * mx, -2 * my * y - tolerance(mx, my)));
+        }
+      }
+
+      std::size_t n = 0;
+      for (std::size_t a = 0; a < an; ++a)
+      {
+        for (std::size_t r = 0; r < rn; ++r)
+        {
+          auto s = intersect(ang[a], ring[r]);
+          if (s.empty()) { continue; }
+          std::size_t i = n++;
+          for (; i && spans[i - 1].first > s.first; --i) { spans[i] = spans[i - 1]; }
+          spans[i] = s;
+        }
+      }
+      if (n < 2) { return n; }
+
+      std::size_t m = 0;
+      for (std::size_t i = 1; i < n; ++i)
+      {
+        if (spans[i].first <= spans[m].last + 1)
+        {
+          if (spans[m].last < spans[i].last) { spans[m].last = spans[i].last; }
+        }
+        else
+        {
+          spans[++m] = spans[i];
+        }
+      }
+      return m + 1;
+    }
+
+    /// Coverage of pixel (x, y) for the anti-aliased variant. 0 (outside) ～ 16 (inside).
+    /// アンチエイリアス用の画素(x, y)の被覆率。0(外側) ～ 16(内側)
+    std::uint_fast8_t getCoverage(std::int32_t x, std::int32_t y) const
+    {
+      std::int32_t cov = 16;
+      if (_mode != mode_full)
+      { // signed distance to the start / end edges in 1/16 pixel.
+        std::int32_t cs = (_sx * y - _sy * x) >> (shift - 4);
+        std::int32_t ce = (_ey * x - _ex * y) >> (shift - 4);
+        cov = (_mode == mode_union) ? (cs > ce ? cs : ce) : (cs < ce ? cs : ce);
+        cov += 8;
+        if (_mode == mode_narrow && (_sx + _ex) * x + (_sy + _ey) * y < 0) { return 0; }
+        if (cov <= 0) { return 0; }
+        if (cov > 16) { cov = 16; }
+      }
+
+      // distance from the center in 1/16 pixel, measured along y for ellipses.
+      // 中心からの距離(1/16画素単位)。楕円の場合はy軸方向の長さで測る
+      std::int32_t y16 = y * 16;
+      std::int32_t xo = _circle ? x * 16 : (_r0x ? x * 16 * _r0y / _r0x : 0);
+      std::uint32_t d2 = xo * xo + y16 * y16;
+      std::int32_t ro = _r0y << 4;
+      if (d2 > (std::uint32_t)(ro * ro))
+      {
+        std::int32_t c = ro + 16 - (std::int32_t)isqrt(d2);
+        if (c <= 0) { return 0; }
+        if (cov > c) { cov = c; }
+      }
+      if (_r1y > 0)
+      {
+        if (!_circle)
+        {
+          std::int32_t xi = _r1x ? x * 16 * _r1y / _r1x : 0;
+          d2 = xi * xi + y16 * y16;
+        }
+        std::int32_t ri = _r1y << 4;
+        if (d2 < (std::uint32_t)(ri * ri))
+        {
+          std::int32_t c = (std::int32_t)isqrt(d2) - ri + 16;
+          if (c <= 0) { return 0; }
+          if (cov > c) { cov = c; }
+        }
+      }
+      return cov;
+    }
+
+    static std::uint32_t isqrt(std::uint32_t v)
+    {
+      std::uint32_t res = 0;
+      std::uint32_t bit = 1u << 30;
+      while (bit > v) { bit >>= 2; }
+      while (bit)
+      {
+        if (v >= res + bit)
+        {
+          v -= res + bit;
+          res = (res >> 1) + bit;
+        }
+        else
+        {
+          res >>= 1;
+        }
+        bit >>= 2;
+      }
+      return res;
+    }
+
+  private:
+    static constexpr std::int32_t shift = 13;
+    static constexpr std::int32_t one = 1 << shift;
+    static constexpr std::int32_t inf = 0x7FFF;
+
+    enum mode_t : std::uint8_t
+    { mode_full    // whole ring
+    , mode_narrow  // sweep < 90 (including radial lines)
+    , mode_wedge   // 90 <= sweep <= 180
+    , mode_union   // 180 < sweep < 360
+    };
+
+    std::int32_t _r0x, _r1x, _r0y, _r1y;
+    std::int32_t _o2x, _o2y, _i2x, _i2y;
+    std::int32_t _sx = 0, _sy = 0, _ex = 0, _ey = 0;
+    std::int32_t _xo;
+    std::int32_t _xi = 0;
+    mode_t _mode;
+    bool _circle;
+
+    static std::int32_t abs32(std::int32_t v) { return v < 0 ? -v : v; }
+
+    // strict "less than half a pixel" becomes ">= -tolerance" after doubling.
+    static std::int32_t tolerance(std::int32_t vx, std::int32_t vy)
+    {
+      vx = abs32(vx);
+      vy = abs32(vy);
+      return (vx > vy ? vx : vy) - 1;
+    }
+
+    static std::int32_t floor_div(std::int32_t n, std::int32_t d)
+    {
+      std::int32_t q = n / d;
+      if ((n % d) && ((n < 0) != (d < 0))) { --q; }
+      return q;
+    }
+
+    static range_t intersect(const range_t& a, const range_t& b)
+    {
+      return { a.first > b.first ? a.first : b.first
+             , a.last  < b.last  ? a.last  : b.last };
+    }
+
+    /// { x | a * x >= c }
+    static range_t halfplane(std::int32_t a, std::int32_t c)
+    {
+      if (a > 0) { return { clamp(-floor_div(-c, a)), inf }; }
+      if (a < 0) { return { -inf, clamp(floor_div(c, a)) }; }
+      return (c <= 0) ? range_t { -inf, inf } : range_t { 1, 0 };
+    }
+
+    static std::int_fast16_t clamp(std::int32_t v)
+    {
+      return v < -inf ? -inf : v > inf ? inf : v;
+    }
+
+    /// ring of row y : outer  x^2 < r0x(r0x+1) (1 - y^2 / r0y(r0y+1))
+    ///                 inner  x^2 >= r1x(r1x-1) (1 - y^2 / r1y(r1y-1))
+    std::size_t ring_row(std::int32_t y, range_t* ring)
+    {
+      std::int32_t y2 = y * y;
+      std::int32_t co, ci;
+      if (_circle)
+      {
+        co = _o2y - y2;
+        ci = _i2y - y2;
+      }
+      else
+      {
+        co = (_o2x && _o2y) ? (std::int32_t)(((std::int64_t)(_o2y - y2) * _o2x + _o2y - 1) / _o2y) : 0;
+        ci = (_i2x && _i2y) ? (std::int32_t)(((std::int64_t)(_i2y - y2) * _i2x) / _i2y) : 0;
+        if (_o2y - y2 < 0) { co = 0; }
+        if (_i2y - y2 < 0) { ci = 0; }
+      }
+      if (co <= 0) { return 0; }
+
+      std::int32_t xo = _xo;
+      while (xo > 0 && xo * xo >= co) { --xo; }
+      while ((xo + 1) * (xo + 1) < co) { ++xo; }
+      _xo = xo;
+
+      std::int32_t xi = 0;
+      if (ci > 0)
+      {
+        xi = _xi;
+        while (xi > 0 && (xi - 1) * (xi - 1) >= ci) { --xi; }
+        while (xi * xi < ci) { ++xi; }
+        _xi = xi;
+      }
+
+      if (xi > xo) { return 0; }
+      if (xi == 0)
+      {
+        ring[0].first = -xo; ring[0].last = xo;
+        return 1;
+      }
+      ring[0].first = -xo; ring[0].last = -xi;
+      ring[1].first =  xi; ring[1].last =  xo;
+      return 2;
+    }
+  };
+
+//----------------------------------------------------------------------------
+
+  /// Spans of the last arc drawn with it. Passing the same instance again redraws only the spans that changed,
+  /// e.g. animating the end angle of a gauge touches only the pixels between the old and new angle.
+  /// 最後に描画した円弧のスパンを保持する。同じインスタンスを再度渡すと変化したスパンだけを描き直す。
+  /// (例:ゲージの終了角を動かす場合、新旧の角度の間の画素だけが描画される)
+  struct arc_spans_t
+  {
+    static constexpr std::size_t max_spans = arc_span_generator_t::max_spans;
+
+    struct row_t
+    {
+      std::int16_t count;
+      std::int16_t x[max_spans * 2]; // first, last, first, last...
+    };
+
+    arc_spans_t(void) = default;
+    arc_spans_t(const arc_spans_t&) = delete;
+    arc_spans_t& operator=(const arc_spans_t&) = delete;
+    ~arc_spans_t(void) { release(); }
+
+    /// Forget the stored spans. The next draw paints the whole arc.
+    /// 保持しているスパンを破棄する。次回は円弧全体を描画する
+    void release(void)
+    {
+      if (_rows) { heap_free(_rows); }
+      _rows = nullptr;
+      _r0y = -1;
+    }
+
+    /// true : stored spans belong to an arc of the same center and radii.
+    bool match(std::int32_t x, std::int32_t y, std::int32_t r0x, std::int32_t r1x, std::int32_t r0y, std::int32_t r1y) const
+    {
+      return _rows && _x == x && _y == y && _r0x == r0x && _r1x == r1x && _r0y == r0y && _r1y == r1y;
+    }
+
+    /// Prepare empty rows for an arc of this center and radii.
+    /// @return false : out of memory.
+    bool reset(std::int32_t x, std::int32_t y, std::int32_t r0x, std::int32_t r1x, std::int32_t r0y, std::int32_t r1y)
+    {
+      if (_r0y != r0y)
+      {
+        release();
+        _rows = (row_t*)heap_alloc(sizeof(row_t) * (r0y * 2 + 1));
+        if (!_rows) { return false; }
+      }
+      _x = x; _y = y; _r0x = r0x; _r1x = r1x; _r0y = r0y; _r1y = r1y;
+      memset(_rows, 0, sizeof(row_t) * (r0y * 2 + 1));
+      return true;
+    }
+
+    /// row y relative to the center (-r0y ～ r0y).
+    row_t* row(std::int32_t y) { return &_rows[y + _r0y]; }
+
+  private:
+    row_t* _rows = nullptr;
+    std::int32_t _x = 0, _y = 0, _r0x = 0, _r1x = 0, _r0y = -1, _r1y = 0;
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -61,88 +61,118 @@ namespace lgfx
             && (biBitCount <= 32)
             && (biBitCount != 0));
     }
+  };
 
-    static bool load_bmp_rle8(DataWrapper* data, std::uint8_t* linebuf, uint_fast16_t width)
+  /// Decoder for RLE8 / RLE4 compressed bitmaps. The stream is read in blocks, delta and end-of-bitmap codes are supported.
+  /// RLE8 / RLE4 圧縮BMPのデコーダ。ストリームはまとめて読込み、デルタ・ビットマップ終端コードに対応する
+  struct bitmap_rle_decoder_t
+  {
+    /// @param bpp 8 (RLE8) or 4 (RLE4)
+    /// @param size compressed data size (biSizeImage). 0 : unknown
+    bitmap_rle_decoder_t(DataWrapper* data, uint_fast8_t bpp, std::uint32_t size = 0)
+    : _data { data }
+    , _remain { size ? size : ~0u }
+    , _bpp { (std::uint8_t)bpp }
+    {}
+
+    /// Decode one row into linebuf ((width * bpp + 7) >> 3 bytes). Pixels skipped by delta or end-of-bitmap are index 0.
+    /// 1行分をlinebufに展開する。デルタ・終端で省略された画素はインデックス0になる
+    bool decodeLine(std::uint8_t* linebuf, uint_fast16_t width)
     {
-      width = (width + 3) & ~3;
-      std::uint8_t code[2];
-      uint_fast16_t xidx = 0;
-      bool eol = false;
-      do {
-        data->read(code, 2);
-        if (code[0] == 0) {
-          switch (code[1]) {
-          case 0x00: // EOL
-          case 0x01: // EOB
-            eol = true;
-            break;
-
-          case 0x02: // move info  (not support)
-            return false;
-
-          default:
-            data->read(&linebuf[xidx], (code[1] + 1) & ~1); // word align
-            xidx += code[1];
-            break;
+      memset(linebuf, 0, (width * _bpp + 7) >> 3);
+      if (_skip_rows) { --_skip_rows; return true; }
+      if (_eob) { return true; }
+
+      std::uint32_t x = _next_x;
+      _next_x = 0;
+      for (;;)
+      {
+        std::int32_t c0 = get();
+        std::int32_t c1 = get();
+        if (c1 < 0) { return false; }
+        if (c0)
+        { // encoded mode : c0 pixels of c1 (RLE4 : two alternating indices)
+          for (std::int32_t i = 0; i < c0; ++i)
+          {
+            put(linebuf, width, x++, (_bpp == 8) ? c1 : (i & 1) ? (c1 & 15) : (c1 >> 4));
           }
-        } else if (xidx + code[0] <= width) {
-          memset(&linebuf[xidx], code[1], code[0]);
-          xidx += code[0];
-        } else {
-          return false;
+          continue;
         }
-      } while (!eol);
-      return true;
-    }
+        switch (c1)
+        {
+        case 0: // end of line
+          return true;
+
+        case 1: // end of bitmap
+          _eob = true;
+          return true;
+
+        case 2: // delta
+          {
+            std::int32_t dx = get();
+            std::int32_t dy = get();
+            if (dy < 0) { return false; }
+            x += dx;
+            if (dy)
+            {
+              _skip_rows = dy - 1;
+              _next_x = x;
+              return true;
+            }
+          }
+          break;
 
-    static bool load_bmp_rle4(DataWrapper* data, std::uint8_t* linebuf, uint_fast16_t width)
-    {
-      width = (width + 3) & ~3;
-      std::uint8_t code[2];
-      uint_fast16_t xidx = 0;
-      bool eol = false;
-      do {
-        data->read(code, 2);
-        if (code[0] == 0) {
-          switch (code[1]) {
-          case 0x00: // EOL
-          case 0x01: // EOB
-            eol = true;
-            break;
-
-          case 0x02: // move info  (not support)
-            return false;
-
-          default:  // 絶対モードデータ
+        default: // absolute mode : c1 pixels, word aligned
+          {
+            std::uint32_t bytes = (_bpp == 8) ? c1 : (c1 + 1) >> 1;
+            for (std::uint32_t i = 0; i < bytes; ++i)
             {
-              int_fast16_t len = code[1];
-              int_fast16_t dbyte = ((int_fast16_t)code[1] + 1) >> 1;
-
-              data->read(&linebuf[(xidx + 1) >> 1], (dbyte + 1) & ~1); // word align
-              if (xidx & 1) {
-                linebuf[xidx >> 1] |= linebuf[(xidx >> 1) + 1] >> 4;
-                for (long i = 1; i < dbyte; ++i) {
-                  linebuf[((xidx + i) >> 1)] = (linebuf[((xidx + i) >> 1)    ] << 4)
-                                              |  linebuf[((xidx + i) >> 1) + 1] >> 4;
-                }
+              std::int32_t d = get();
+              if (d < 0) { return false; }
+              if (_bpp == 8) { put(linebuf, width, x++, d); }
+              else
+              {
+                put(linebuf, width, x++, d >> 4);
+                if ((i << 1) + 1 < (std::uint32_t)c1) { put(linebuf, width, x++, d & 15); }
               }
-              xidx += len;
             }
-            break;
+            if (bytes & 1) { get(); }
           }
-        } else if (xidx + code[0] <= width) {
-          if (xidx & 1) {
-            linebuf[xidx >> 1] |= code[1] >> 4;
-            code[1] = (code[1] >> 4) | (code[1] << 4);
-          }
-          memset(&linebuf[(xidx + 1) >> 1], code[1], (code[0] + 1) >> 1);
-          xidx += code[0];
-          if (xidx & 1) linebuf[xidx >> 1] &= 0xF0;
-        } else {
-          return false;
+          break;
         }
-      } while (!eol);
-      return true;
+      }
+    }
+
+  private:
+    DataWrapper* _data;
+    std::uint32_t _remain;
+    std::uint32_t _skip_rows = 0;
+    std::uint32_t _next_x = 0;
+    std::uint16_t _pos = 0;
+    std::uint16_t _len = 0;
+    std::uint8_t _bpp;
+    bool _eob = false;
+    std::uint8_t _buf[128];
+
+    std::int32_t get(void)
+    {
+      if (_pos == _len)
+      {
+        std::uint32_t len = _remain < sizeof(_buf) ? _remain : sizeof(_buf);
+        std::int32_t res = len ? _data->read(_buf, len) : 0;
+        if (res <= 0) { return -1; }
+        _remain -= res;
+        _len = res;
+        _pos = 0;
+      }
+      return _buf[_pos++];
+    }
+
+    void put(std::uint8_t* linebuf, std::uint32_t width, std::uint32_t x, std::uint_fast8_t index) const
+    {
+      if (x >= width) { return; }
+      if (_bpp == 8) { linebuf[x] = index; }
+      else { linebuf[x >> 1] |= index << ((~x & 1) << 2); }
     }
   };
 
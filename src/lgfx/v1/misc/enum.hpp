@@ -202,6 +202,17 @@ namespace lgfx
   }
   using namespace attribute;
 
+//----------------------------------------------------------------------------
+
+  namespace fill_rule
+  {
+    enum fill_rule_t : std::uint8_t
+    { fill_nonzero = 0  // inside where the winding number is not zero
+    , fill_evenodd = 1  // inside where the number of crossed edges is odd
+    };
+  }
+  using namespace fill_rule;
+
 //----------------------------------------------------------------------------
 
   enum color_depth_t : std::uint16_t
@@ -250,3 +261,4 @@ using namespace lgfx::textdatum;
 using namespace lgfx::datum;
 using namespace lgfx::attribute;
 using namespace lgfx::epd_mode;
+using namespace lgfx::fill_rule;
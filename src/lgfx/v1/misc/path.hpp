@@ -0,0 +1,206 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// edge of the scanline fill. covers scanlines y0 ～ y1-1, x is 16.16 fixed point.
+  struct path_edge_t
+  {
+    std::int32_t x;   // x at scanline y0
+    std::int32_t dx;  // x step per scanline
+    std::int16_t y0;
+    std::int16_t y1;
+    std::int8_t dir;  // 1 : downward  -1 : upward
+  };
+
+  /// entry of the active edge table.
+  struct path_active_t
+  {
+    std::int32_t x;
+    std::uint16_t edge;
+  };
+
+  /// Outline made of lines and Bezier curves, stored as an edge list for fillPath. Curves are flattened when added.
+  /// The storage is supplied by the owner (see path_buffer_t), so building and filling a path never allocates.
+  /// 直線とベジェ曲線からなる輪郭。fillPath用の辺リストとして保持し、曲線は追加時に折れ線化する。
+  /// 領域は所有者が用意する(path_buffer_t参照)ため、構築・塗りつぶしでメモリ確保は行わない
+  struct path_t
+  {
+    path_t(path_edge_t* edges, path_active_t* active, std::uint16_t capacity)
+    : _edges { edges }, _active { active }, _capacity { capacity }
+    {}
+
+    void clear(void)
+    {
+      _count = 0;
+      _bottom = INT16_MIN;
+      _overflow = false;
+      _sorted = true;
+      _start_x = _start_y = _x = _y = 0;
+    }
+
+    /// Begin a new sub path. The previous one is closed.
+    void moveTo(float x, float y)
+    {
+      closePath();
+      _start_x = _x = x;
+      _start_y = _y = y;
+    }
+
+    void lineTo(float x, float y)
+    {
+      add_edge(_x, _y, x, y);
+      _x = x;
+      _y = y;
+    }
+
+    /// quadratic Bezier curve with control point (cx, cy)
+    void quadTo(float cx, float cy, float x, float y)
+    {
+      float x0 = _x, y0 = _y;
+      std::int32_t n = segments(fabsf(x0 - 2 * cx + x) + fabsf(y0 - 2 * cy + y), 1.0f);
+      for (std::int32_t i = 1; i < n; ++i)
+      {
+        float t = (float)i / n;
+        float u = 1.0f - t;
+        lineTo(u * u * x0 + 2 * u * t * cx + t * t * x
+             , u * u * y0 + 2 * u * t * cy + t * t * y);
+      }
+      lineTo(x, y);
+    }
+
+    /// cubic Bezier curve with control points (c0x, c0y), (c1x, c1y)
+    void cubicTo(float c0x, float c0y, float c1x, float c1y, float x, float y)
+    {
+      float x0 = _x, y0 = _y;
+      float d0 = fabsf(x0 - 2 * c0x + c1x) + fabsf(y0 - 2 * c0y + c1y);
+      float d1 = fabsf(c0x - 2 * c1x + x) + fabsf(c0y - 2 * c1y + y);
+      std::int32_t n = segments(d0 > d1 ? d0 : d1, 3.0f);
+      for (std::int32_t i = 1; i < n; ++i)
+      {
+        float t = (float)i / n;
+        float u = 1.0f - t;
+        float a = u * u * u, b = 3 * u * u * t, c = 3 * u * t * t, d = t * t * t;
+        lineTo(a * x0 + b * c0x + c * c1x + d * x
+             , a * y0 + b * c0y + c * c1y + d * y);
+      }
+      lineTo(x, y);
+    }
+
+    /// Close the current sub path with a line to its start point.
+    void closePath(void)
+    {
+      if (_x != _start_x || _y != _start_y) { lineTo(_start_x, _start_y); }
+    }
+
+    /// false : some edges were dropped because the capacity was exhausted.
+    bool isValid(void) const { return !_overflow; }
+
+    std::uint16_t edgeCount(void) const { return _count; }
+    std::uint16_t capacity(void) const { return _capacity; }
+
+    /// sort the edges by their first scanline.
+    void sort(void)
+    {
+      if (_sorted) return;
+      for (std::size_t i = 1; i < _count; ++i)
+      {
+        auto e = _edges[i];
+        std::size_t j = i;
+        for (; j && _edges[j - 1].y0 > e.y0; --j) { _edges[j] = _edges[j - 1]; }
+        _edges[j] = e;
+      }
+      _sorted = true;
+    }
+
+    path_edge_t* edges(void) { return _edges; }
+    path_active_t* active(void) { return _active; }
+    std::int32_t bottom(void) const { return _bottom; }
+
+  private:
+    path_edge_t* _edges;
+    path_active_t* _active;
+    std::uint16_t _capacity;
+    std::uint16_t _count = 0;
+    std::int16_t _bottom = INT16_MIN;
+    bool _overflow = false;
+    bool _sorted = true;
+    float _start_x = 0, _start_y = 0;
+    float _x = 0, _y = 0;
+
+    /// number of line segments keeping the flattening error under 1/4 pixel.
+    static std::int32_t segments(float dd, float k)
+    {
+      std::int32_t n = ceilf(sqrtf(dd * k));
+      return n < 1 ? 1 : n > 64 ? 64 : n;
+    }
+
+    void add_edge(float x0, float y0, float x1, float y1)
+    {
+      std::int8_t dir = 1;
+      if (y0 > y1)
+      {
+        float t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+        dir = -1;
+      }
+      // scanlines are sampled at the pixel centers (integer y), a scanline on the lower end is excluded.
+      std::int32_t sy0 = ceilf(y0);
+      std::int32_t sy1 = ceilf(y1);
+      if (sy0 >= sy1) return;
+      if (_count == _capacity) { _overflow = true; return; }
+
+      float slope = (x1 - x0) / (y1 - y0);
+      auto e = &_edges[_count];
+      e->x  = lroundf((x0 + (sy0 - y0) * slope) * 65536.0f);
+      e->dx = lroundf(slope * 65536.0f);
+      e->y0 = sy0;
+      e->y1 = sy1;
+      e->dir = dir;
+      if (_count && _edges[_count - 1].y0 > sy0) { _sorted = false; }
+      if (_bottom < sy1) { _bottom = sy1; }
+      ++_count;
+    }
+  };
+
+  /// path_t with storage for N edges. Put it on the stack or keep it as a member.
+  /// 辺N本分の領域を持つpath_t。スタック上に置くか、メンバとして保持する
+  template <std::uint16_t N>
+  struct path_buffer_t : public path_t
+  {
+    path_buffer_t(void) : path_t(_edge_buf, _active_buf, N) {}
+    path_buffer_t(const path_buffer_t&) = delete;
+    path_buffer_t& operator=(const path_buffer_t&) = delete;
+
+  private:
+    path_edge_t _edge_buf[N];
+    path_active_t _active_buf[N];
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
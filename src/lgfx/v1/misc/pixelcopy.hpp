@@ -524,38 +524,72 @@ namespace lgfx
       return last;
     }
 
+    template <typename TDst>
+    static inline void blend_pixel(TDst& d, const argb8888_t& s, std::uint_fast16_t a)
+    {
+      std::uint_fast16_t inv = 256 - a;
+      ++a;
+      d.set( (d.R8() * inv + s.R8() * a) >> 8
+           , (d.G8() * inv + s.G8() * a) >> 8
+           , (d.B8() * inv + s.B8() * a) >> 8
+           );
+    }
+
+    /// R と B を1ワードにまとめて乗算する。結果は汎用版と同一。
+    static inline void blend_pixel(bgr888_t& d, const argb8888_t& s, std::uint_fast16_t a)
+    {
+      std::uint32_t inv = 256 - a;
+      ++a;
+      std::uint32_t drb = d.r << 16 | d.b;
+      std::uint32_t srb = s.raw & 0xFF00FF;
+      std::uint32_t rb = ((srb * a + drb * inv) >> 8) & 0xFF00FF;
+      std::uint32_t g  = ((s.raw & 0xFF00) * a + (d.g << 8) * inv) >> 16;
+      d.r = rb >> 16;
+      d.g = g;
+      d.b = rb;
+    }
+
+    /// RGB565を 00000gggggg00000rrrrr000000bbbbb に展開し、5bitのアルファで3成分を1回の乗算で合成する。
+    static inline void blend_pixel(swap565_t& d, const argb8888_t& s, std::uint_fast16_t a)
+    {
+      std::uint32_t a5 = (a + 4) >> 3;
+      std::uint32_t dc = (d.raw >> 8 | d.raw << 8) & 0xFFFF;
+      std::uint32_t sc = ((s.raw >> 8) & 0xF800) | ((s.raw >> 5) & 0x07E0) | ((s.raw >> 3) & 0x001F);
+      dc = (dc | dc << 16) & 0x07E0F81F;
+      sc = (sc | sc << 16) & 0x07E0F81F;
+      std::uint32_t c = ((sc * a5 + dc * (32 - a5) + 0x02008010) >> 5) & 0x07E0F81F;
+      c |= c >> 16;
+      d.raw = (c >> 8 & 0xFF) | (c << 8 & 0xFF00);
+    }
+
     template <typename TDst>
     static std::uint32_t blend_rgb_fast(void* __restrict__ dst, std::uint32_t index, std::uint32_t last, pixelcopy_t* __restrict__ param)
     {
       auto d = static_cast<TDst*>(dst);
       auto src_x32_add = param->src_x32_add;
       auto src_y32_add = param->src_y32_add;
-/*
       if (src_y32_add == 0 && src_x32_add == (1<<FP_SCALE))
       {
         auto s = &(static_cast<const argb8888_t*>(param->src_data)[param->src_x + param->src_y * param->src_bitwidth - index]);
-        for (;;) {
+        param->src_x32 += (last - index) << FP_SCALE;
+        do
+        {
           std::uint_fast16_t a = s[index].a;
           if (a)
           {
             if (a == 255)
             {
               d[index].set(s[index].r, s[index].g, s[index].b);
-              if (++index == last) return last;
-              continue;
             }
-
-            std::uint_fast16_t inv = 256 - a;
-            ++a;
-            d[index].set( (d[index].R8() * inv + s[index].R8() * a) >> 8
-                        , (d[index].G8() * inv + s[index].G8() * a) >> 8
-                        , (d[index].B8() * inv + s[index].B8() * a) >> 8
-                        );
+            else
+            {
+              blend_pixel(d[index], s[index], a);
+            }
           }
-          if (++index == last) return last;
-        }
+        } while (++index != last);
+        return last;
       }
-//*/
+
       auto s = static_cast<const argb8888_t*>(param->src_data);
       for (;;) {
         std::uint32_t i = param->src_x + param->src_y * param->src_bitwidth;
@@ -565,18 +599,11 @@ namespace lgfx
           if (a == 255)
           {
             d[index].set(s[i].r, s[i].g, s[i].b);
-            param->src_x32 += src_x32_add;
-            param->src_y32 += src_y32_add;
-            if (++index == last) return last;
-            continue;
           }
-
-          std::uint_fast16_t inv = 256 - a;
-          ++a;
-          d[index].set( (d[index].R8() * inv + s[i].R8() * a) >> 8
-                      , (d[index].G8() * inv + s[i].G8() * a) >> 8
-                      , (d[index].B8() * inv + s[i].B8() * a) >> 8
-                      );
+          else
+          {
+            blend_pixel(d[index], s[i], a);
+          }
         }
         param->src_x32 += src_x32_add;
         param->src_y32 += src_y32_add;
@@ -655,6 +682,32 @@ namespace lgfx
       } while (++index != last);
       return index;
     }
+
+    /// Fill len pixels of bytes (1-3) bytes each with a raw color.
+    static void fill_raw(void* __restrict__ dst, std::uint32_t rawcolor, std::uint32_t bytes, std::uint32_t len)
+    {
+      if (bytes == 1)
+      {
+        memset(dst, rawcolor, len);
+      }
+      else if (bytes == 2)
+      {
+        auto d = static_cast<std::uint16_t*>(dst);
+        do { *d++ = rawcolor; } while (--len);
+      }
+      else
+      {
+        auto d = static_cast<std::uint8_t*>(dst);
+        auto c = reinterpret_cast<const std::uint8_t*>(&rawcolor);
+        do
+        {
+          d[0] = c[0];
+          d[1] = c[1];
+          d[2] = c[2];
+          d += 3;
+        } while (--len);
+      }
+    }
   };
 
 //----------------------------------------------------------------------------
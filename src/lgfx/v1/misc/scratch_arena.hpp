@@ -0,0 +1,231 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "../platforms/common.hpp"
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// Growable stack of scratch memory for the temporary buffers of drawing functions.
+  /// Memory taken after a checkpoint_t is given back when the checkpoint leaves its scope, the chunks stay allocated for the next call.
+  /// Chunks come from DMA capable memory. Not thread safe.
+  /// 描画関数の一時バッファ用の伸長可能なスクラッチ領域。
+  /// checkpoint_t以降に確保したメモリはスコープを抜けると返却され、チャンクは次回の呼出し用に保持される。
+  /// チャンクはDMA転送可能なメモリから確保する。スレッドセーフではない
+  class ScratchArena
+  {
+  public:
+    /// restores the arena to the state at construction when it leaves its scope.
+    /// 生成時の状態に、スコープを抜ける際に戻す
+    class checkpoint_t
+    {
+    public:
+      checkpoint_t(ScratchArena* arena)
+      : _arena { arena }, _chunk { arena->_cur }, _pos { arena->_pos }, _used { arena->_used }
+      {}
+      checkpoint_t(const checkpoint_t&) = delete;
+      checkpoint_t& operator=(const checkpoint_t&) = delete;
+      ~checkpoint_t(void) { _arena->rewind(_chunk, _pos, _used); }
+
+    private:
+      ScratchArena* _arena;
+      void* _chunk;
+      std::size_t _pos;
+      std::size_t _used;
+    };
+
+    ScratchArena(void) = default;
+    // the chunks are never shared, a copy starts empty.
+    ScratchArena(const ScratchArena&) {}
+    ScratchArena& operator=(const ScratchArena&) { return *this; }
+    ~ScratchArena(void) { release(); }
+
+    /// Returns nullptr when no memory is available. align must be a power of two up to 16.
+    void* allocate(std::size_t length, std::size_t align = 4)
+    {
+      if (length == 0) { length = 1; }
+      chunk_t* c = static_cast<chunk_t*>(_cur);
+      std::size_t pos = (_pos + align - 1) & ~(align - 1);
+      if (c == nullptr || pos + length > c->size)
+      { // move to the next chunk, a new one is inserted when it is too small.
+        chunk_t* next = c ? c->next : static_cast<chunk_t*>(_head);
+        if (next == nullptr || length > next->size)
+        {
+          std::size_t size = min_chunk;
+          if (_capacity > size) { size = _capacity; }
+          if (_hint > size) { size = _hint; }
+          if (length > size) { size = length; }
+          auto n = static_cast<chunk_t*>(heap_alloc_dma(header_len + size));
+          if (n == nullptr) { return nullptr; }
+          n->size = size;
+          n->next = next;
+          if (c) { c->next = n; }
+          else   { _head = n; }
+          _capacity += size;
+          _hint = 0;
+          next = n;
+        }
+        _used += c ? c->size - _pos : 0;
+        c = next;
+        _cur = c;
+        _pos = pos = 0;
+      }
+      _used += pos - _pos + length;
+      if (_peak < _used) { _peak = _used; }
+      _pos = pos + length;
+      return reinterpret_cast<std::uint8_t*>(c) + header_len + pos;
+    }
+
+    template <typename T>
+    T* allocate_array(std::size_t count)
+    {
+      return static_cast<T*>(allocate(count * sizeof(T), alignof(T) < 16 ? alignof(T) : 16));
+    }
+
+    /// Allocate the chunks beforehand, so the first drawing call does not reach the heap.
+    bool reserve(std::size_t length)
+    {
+      if (_head == nullptr || _capacity < length)
+      {
+        if (_used) { return false; }
+        release();
+        _hint = length;
+        checkpoint_t cp(this);
+        return allocate(length) != nullptr;
+      }
+      return true;
+    }
+
+    /// Free all chunks. Must not be called while memory of the arena is in use.
+    void release(void)
+    {
+      auto c = static_cast<chunk_t*>(_head);
+      while (c)
+      {
+        auto next = c->next;
+        heap_free(c);
+        c = next;
+      }
+      _head = _cur = nullptr;
+      _pos = _used = _capacity = 0;
+    }
+
+    /// bytes in use now, alignment padding and unused chunk tails included.
+    std::size_t used(void) const { return _used; }
+    /// maximum of used() since construction or resetPeak().
+    std::size_t peak(void) const { return _peak; }
+    /// bytes of all chunks.
+    std::size_t capacity(void) const { return _capacity; }
+    void resetPeak(void) { _peak = _used; }
+
+  private:
+    struct chunk_t
+    {
+      chunk_t* next;
+      std::size_t size;
+    };
+    enum : std::size_t
+    { header_len = (sizeof(chunk_t) + 15) & ~15u
+    , min_chunk = 256
+    };
+
+    void* _head = nullptr;
+    void* _cur = nullptr;
+    std::size_t _pos = 0;
+    std::size_t _used = 0;
+    std::size_t _peak = 0;
+    std::size_t _capacity = 0;
+    std::size_t _hint = 0;
+
+    void rewind(void* chunk, std::size_t pos, std::size_t used)
+    {
+      _cur = chunk;
+      _pos = pos;
+      _used = used;
+      // once the arena is empty, several chunks are merged into one on the next allocation.
+      if (used == 0 && _head && static_cast<chunk_t*>(_head)->next)
+      {
+        std::size_t capacity = _capacity;
+        release();
+        _hint = capacity;
+      }
+    }
+  };
+
+  /// Recycles fixed size blocks taken from a ScratchArena, for node based containers (see scratch_allocator_t).
+  /// ScratchArenaから確保した固定長ブロックを再利用する。ノードベースのコンテナ用(scratch_allocator_t参照)
+  struct scratch_node_pool_t
+  {
+    scratch_node_pool_t(ScratchArena* arena) : _arena { arena } {}
+
+    void* allocate(std::size_t length)
+    {
+      if (_free && length == _length)
+      {
+        auto p = _free;
+        _free = *static_cast<void**>(p);
+        return p;
+      }
+      return _arena->allocate(length < sizeof(void*) ? sizeof(void*) : length, 8);
+    }
+
+    void deallocate(void* p, std::size_t length)
+    {
+      if (_free && length != _length) { return; }
+      _length = length;
+      *static_cast<void**>(p) = _free;
+      _free = p;
+    }
+
+  private:
+    ScratchArena* _arena;
+    void* _free = nullptr;
+    std::size_t _length = 0;
+  };
+
+  /// allocator for standard containers, e.g. std::list<T, scratch_allocator_t<T>>.
+  /// the pool must be created after the checkpoint of the arena and live longer than the container.
+  /// 標準コンテナ用アロケータ。プールはアリーナのチェックポイントより後に生成し、コンテナより長く保持すること
+  template <typename T>
+  struct scratch_allocator_t
+  {
+    typedef T value_type;
+
+    scratch_allocator_t(scratch_node_pool_t* pool) : _pool { pool } {}
+    template <typename U>
+    scratch_allocator_t(const scratch_allocator_t<U>& rhs) : _pool { rhs._pool } {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(_pool->allocate(n * sizeof(T))); }
+    void deallocate(T* p, std::size_t n) { _pool->deallocate(p, n * sizeof(T)); }
+
+    template <typename U> bool operator==(const scratch_allocator_t<U>& rhs) const { return _pool == rhs._pool; }
+    template <typename U> bool operator!=(const scratch_allocator_t<U>& rhs) const { return _pool != rhs._pool; }
+
+    scratch_node_pool_t* _pool;
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
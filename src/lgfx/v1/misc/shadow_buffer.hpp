@@ -0,0 +1,404 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "enum.hpp"
+#include "colortype.hpp"
+#include "../platforms/common.hpp"
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// RAM copy of the panel memory, updated by every write of the panel. Pixels are read back from it instead of the bus.
+  /// It covers the whole panel or one tile (rectangle in panel memory coordinates), optionally reduced to RGB332.
+  /// パネルメモリのRAM上の複製。パネルへの書込み毎に更新し、画素の読出しはバスではなくここから行う。
+  /// パネル全体または1つのタイル(パネルメモリ座標の矩形)を保持し、RGB332に減色して保持することもできる
+  struct shadow_buffer_t
+  {
+    shadow_buffer_t(void) = default;
+    shadow_buffer_t(const shadow_buffer_t&) = delete;
+    shadow_buffer_t& operator=(const shadow_buffer_t&) = delete;
+    ~shadow_buffer_t(void) { release(); }
+
+    /// @param depth  rgb332_1Byte / rgb565_2Byte / rgb666_3Byte / rgb888_3Byte
+    /// @param w,h  tile size. 0 : whole panel
+    bool create(std::uint_fast16_t panel_width, std::uint_fast16_t panel_height, color_depth_t depth, bool psram
+              , std::uint_fast16_t x = 0, std::uint_fast16_t y = 0, std::uint_fast16_t w = 0, std::uint_fast16_t h = 0)
+    {
+      release();
+      if (w == 0) { x = 0; w = panel_width;  }
+      if (h == 0) { y = 0; h = panel_height; }
+      if (x + w > panel_width || y + h > panel_height) { return false; }
+
+      _bytes = (depth & color_depth_t::bit_mask) > 16 ? 3 : (depth & color_depth_t::bit_mask) > 8 ? 2 : 1;
+      _depth = _bytes == 3 ? (depth == rgb666_3Byte ? rgb666_3Byte : rgb888_3Byte)
+             : _bytes == 2 ? rgb565_2Byte : rgb332_1Byte;
+      std::size_t len = (std::size_t)w * h * _bytes;
+      _buf = static_cast<std::uint8_t*>(psram ? heap_alloc_psram(len) : heap_alloc(len));
+      if (_buf == nullptr) { return false; }
+      memset(_buf, 0, len);
+
+      _panel_width  = panel_width;
+      _panel_height = panel_height;
+      _tx = x;
+      _ty = y;
+      _tw = w;
+      _th = h;
+      setRotation(0);
+      setDepth(_depth, _depth);
+      return true;
+    }
+
+    void release(void)
+    {
+      if (_buf) { heap_free(_buf); }
+      _buf = nullptr;
+    }
+
+    bool valid(void) const { return _buf != nullptr; }
+
+    /// true : the whole panel is covered.
+    bool isFull(void) const { return _buf && _tw == _panel_width && _th == _panel_height; }
+
+    color_depth_t getColorDepth(void) const { return _depth; }
+
+    /// pixel formats of the panel : writes are in write_depth, reads return read_depth.
+    void setDepth(color_depth_t write_depth, color_depth_t read_depth)
+    {
+      _fp_in  = get_conv(_depth, write_depth);
+      _fp_out = get_conv(read_depth, _depth);
+      _in_bytes  = (write_depth & color_depth_t::bit_mask) > 16 ? 3 : (write_depth & color_depth_t::bit_mask) > 8 ? 2 : 1;
+      _out_bytes = (read_depth  & color_depth_t::bit_mask) > 16 ? 3 : (read_depth  & color_depth_t::bit_mask) > 8 ? 2 : 1;
+    }
+
+    /// internal rotation of the panel (0~7). Afterwards all coordinates are in the rotated frame, as for the panel writes.
+    void setRotation(std::uint_fast8_t r)
+    {
+      bool fx = (1 << r) & 0b11000110; // case 1:2:6:7:
+      bool fy = (1 << r) & 0b10011100; // case 2:3:4:7:
+      std::int32_t sx = fx ? -1 : 1;
+      std::int32_t sy = fy ? -1 : 1;
+      _px0 = fx ? _panel_width  - 1 : 0;
+      _py0 = fy ? _panel_height - 1 : 0;
+      if (r & 1)
+      { // px = f(y), py = f(x)
+        _m[0] = 0;  _m[1] = sx;
+        _m[2] = sy; _m[3] = 0;
+      }
+      else
+      {
+        _m[0] = sx; _m[1] = 0;
+        _m[2] = 0;  _m[3] = sy;
+      }
+    }
+
+    /// true : the rectangle is entirely kept in this buffer.
+    bool covers(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h) const
+    {
+      if (_buf == nullptr) { return false; }
+      std::int32_t px0, py0, px1, py1;
+      to_panel_rect(x, y, w, h, px0, py0, px1, py1);
+      return px0 >= _tx && py0 >= _ty && px1 < _tx + _tw && py1 < _ty + _th;
+    }
+
+    void setWindow(std::uint_fast16_t xs, std::uint_fast16_t ys, std::uint_fast16_t xe, std::uint_fast16_t ye)
+    {
+      _xs = _xpos = xs;
+      _ys = _ypos = ys;
+      _xe = xe;
+      _ye = ye;
+    }
+
+    /// fill with a raw color of the panel write format.
+    void fill(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, std::uint32_t rawcolor)
+    {
+      if (_buf == nullptr) { return; }
+      std::int32_t px0, py0, px1, py1;
+      to_panel_rect(x, y, w, h, px0, py0, px1, py1);
+      if (px0 < _tx) { px0 = _tx; }
+      if (py0 < _ty) { py0 = _ty; }
+      if (px1 >= _tx + _tw) { px1 = _tx + _tw - 1; }
+      if (py1 >= _ty + _th) { py1 = _ty + _th - 1; }
+      if (px0 > px1 || py0 > py1) { return; }
+
+      std::uint32_t c = convert_color(rawcolor);
+      std::uint32_t len = px1 - px0 + 1;
+      auto d = &_buf[((py0 - _ty) * _tw + px0 - _tx) * _bytes];
+      do
+      {
+        fill_run(d, 1, len, c);
+        d += _tw * _bytes;
+      } while (++py0 <= py1);
+    }
+
+    /// len pixels of one raw color, from the window cursor.
+    void writeBlock(std::uint32_t rawcolor, std::uint32_t len)
+    {
+      if (_buf == nullptr) { return; }
+      std::uint32_t c = convert_color(rawcolor);
+      do
+      {
+        auto n = std::min<std::uint32_t>(len, _xe + 1 - _xpos);
+        std::int32_t step;
+        std::uint32_t kept = n;
+        auto d = clip_run(_xpos, _ypos, kept, step);
+        if (d) { fill_run(d, step, kept, c); }
+        len -= n;
+        advance(n);
+      } while (len);
+    }
+
+    /// len pixels in the panel write format, from the window cursor.
+    void writePixels(const void* src, std::uint32_t len)
+    {
+      std::uint32_t tmp[chunk_len * 3 / 4];
+      auto s = static_cast<const std::uint8_t*>(src);
+      do
+      {
+        auto n = std::min<std::uint32_t>(std::min<std::uint32_t>(len, _xe + 1 - _xpos), chunk_len);
+        std::int32_t step;
+        std::uint32_t kept = n;
+        std::uint32_t skip = 0;
+        auto d = clip_run(_xpos, _ypos, kept, step, &skip);
+        if (d)
+        {
+          _fp_in(tmp, s, n);
+          put_run(d, step, reinterpret_cast<const std::uint8_t*>(tmp) + skip * _bytes, kept);
+        }
+        s += n * _in_bytes;
+        len -= n;
+        advance(n);
+      } while (len);
+    }
+
+    /// read w pixels of row y in the panel read format. Pixels outside the buffer are 0.
+    void readRow(std::int32_t x, std::int32_t y, std::uint32_t w, void* dst)
+    {
+      std::uint32_t tmp[chunk_len * 3 / 4];
+      auto o = static_cast<std::uint8_t*>(dst);
+      do
+      {
+        auto n = std::min<std::uint32_t>(w, chunk_len);
+        load(x, y, n, reinterpret_cast<std::uint8_t*>(tmp));
+        _fp_out(o, tmp, n);
+        o += n * _out_bytes;
+        x += n;
+        w -= n;
+      } while (w);
+    }
+
+    /// copy a rectangle inside the buffer, as the panel does for a hardware copy. Overlapping is allowed.
+    void copyRect(std::int32_t dst_x, std::int32_t dst_y, std::int32_t w, std::int32_t h, std::int32_t src_x, std::int32_t src_y)
+    {
+      if (_buf == nullptr) { return; }
+      std::uint32_t tmp[chunk_len * 3 / 4];
+      auto t = reinterpret_cast<std::uint8_t*>(tmp);
+      std::int32_t dir_y = (src_y < dst_y) ? -1 : 1;
+      std::int32_t row = (dir_y < 0) ? h - 1 : 0;
+      bool reverse = src_x < dst_x;
+      for (std::int32_t j = 0; j < h; ++j, row += dir_y)
+      {
+        std::int32_t pos = reverse ? w : 0;
+        std::int32_t remain = w;
+        do
+        {
+          std::uint32_t n = std::min<std::int32_t>(remain, chunk_len);
+          remain -= n;
+          if (reverse) { pos -= n; }
+          load(src_x + pos, src_y + row, n, t);
+          std::int32_t step;
+          std::uint32_t len = n;
+          std::uint32_t skip = 0;
+          auto d = clip_run(dst_x + pos, dst_y + row, len, step, &skip);
+          if (d) { put_run(d, step, t + skip * _bytes, len); }
+          if (!reverse) { pos += n; }
+        } while (remain);
+      }
+    }
+
+  private:
+    enum : std::uint32_t { chunk_len = 64 };  // pixels converted per step
+
+    using conv_fp_t = void(*)(void*, const void*, std::uint32_t);
+
+    std::uint8_t* _buf = nullptr;
+    conv_fp_t _fp_in  = nullptr;
+    conv_fp_t _fp_out = nullptr;
+    std::int32_t _tx = 0, _ty = 0, _tw = 0, _th = 0;
+    std::int32_t _panel_width = 0, _panel_height = 0;
+    std::int32_t _px0 = 0, _py0 = 0;
+    std::int32_t _m[4] = { 1, 0, 0, 1 };  // panel (px, py) = (_px0 + x * _m[0] + y * _m[1], _py0 + x * _m[2] + y * _m[3])
+    std::int32_t _xs = 0, _ys = 0, _xe = 0, _ye = 0, _xpos = 0, _ypos = 0;
+    color_depth_t _depth = rgb565_2Byte;
+    std::uint8_t _bytes = 2;
+    std::uint8_t _in_bytes = 2;
+    std::uint8_t _out_bytes = 2;
+
+    template <typename TDst, typename TSrc>
+    static void conv_t(void* dst, const void* src, std::uint32_t len)
+    {
+      auto d = static_cast<TDst*>(dst);
+      auto s = static_cast<const TSrc*>(src);
+      for (std::uint32_t i = 0; i < len; ++i) { d[i] = s[i]; }
+    }
+
+    template <std::size_t N>
+    static void copy_t(void* dst, const void* src, std::uint32_t len)
+    {
+      memcpy(dst, src, len * N);
+    }
+
+    template <typename TDst>
+    static conv_fp_t get_conv_dst(color_depth_t src)
+    {
+      return (src == rgb565_2Byte) ? conv_t<TDst, swap565_t>
+           : (src == rgb666_3Byte) ? conv_t<TDst, bgr666_t>
+           : (src == rgb888_3Byte) ? conv_t<TDst, bgr888_t>
+                                   : conv_t<TDst, rgb332_t>;
+    }
+
+    static conv_fp_t get_conv(color_depth_t dst, color_depth_t src)
+    {
+      if (dst == src)
+      {
+        return (dst == rgb332_1Byte) ? copy_t<1>
+             : (dst == rgb565_2Byte) ? copy_t<2>
+                                     : copy_t<3>;
+      }
+      return (dst == rgb565_2Byte) ? get_conv_dst<swap565_t>(src)
+           : (dst == rgb666_3Byte) ? get_conv_dst<bgr666_t>(src)
+           : (dst == rgb888_3Byte) ? get_conv_dst<bgr888_t>(src)
+                                   : get_conv_dst<rgb332_t>(src);
+    }
+
+    std::uint32_t convert_color(std::uint32_t rawcolor) const
+    {
+      std::uint32_t c = 0;
+      _fp_in(&c, &rawcolor, 1);
+      return c;
+    }
+
+    void to_panel_rect(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, std::int32_t& px0, std::int32_t& py0, std::int32_t& px1, std::int32_t& py1) const
+    {
+      std::int32_t x1 = x + w - 1;
+      std::int32_t y1 = y + h - 1;
+      px0 = _px0 + x  * _m[0] + y  * _m[1];
+      py0 = _py0 + x  * _m[2] + y  * _m[3];
+      px1 = _px0 + x1 * _m[0] + y1 * _m[1];
+      py1 = _py0 + x1 * _m[2] + y1 * _m[3];
+      if (px0 > px1) { std::swap(px0, px1); }
+      if (py0 > py1) { std::swap(py0, py1); }
+    }
+
+    /// clip the run of len pixels from (x, y) to the tile. returns the address of the first kept pixel (nullptr : none),
+    /// len becomes the kept length, step the address step in pixels and skip the number of leading pixels dropped.
+    std::uint8_t* clip_run(std::int32_t x, std::int32_t y, std::uint32_t& len, std::int32_t& step, std::uint32_t* skip = nullptr) const
+    {
+      std::int32_t px = _px0 + x * _m[0] + y * _m[1];
+      std::int32_t py = _py0 + x * _m[2] + y * _m[3];
+      std::int32_t a, d, lo;
+      std::int32_t size;
+      if (_m[0])
+      { // the run moves along the panel x axis.
+        if ((std::uint32_t)(py - _ty) >= (std::uint32_t)_th) { return nullptr; }
+        a = px; d = _m[0]; lo = _tx; size = _tw;
+        step = d;
+      }
+      else
+      {
+        if ((std::uint32_t)(px - _tx) >= (std::uint32_t)_tw) { return nullptr; }
+        a = py; d = _m[2]; lo = _ty; size = _th;
+        step = d * _tw;
+      }
+      // pixel i is at a + i * d on the moving axis.
+      std::int32_t i0 = (d > 0) ? lo - a : a - (lo + size - 1);
+      std::int32_t i1 = i0 + size - 1;
+      if (i0 < 0) { i0 = 0; }
+      if (i1 > (std::int32_t)len - 1) { i1 = len - 1; }
+      if (i0 > i1) { return nullptr; }
+      if (skip) { *skip = i0; }
+      len = i1 - i0 + 1;
+      px += _m[0] * i0;
+      py += _m[2] * i0;
+      return &_buf[((py - _ty) * _tw + px - _tx) * _bytes];
+    }
+
+    void fill_run(std::uint8_t* d, std::int32_t step, std::uint32_t len, std::uint32_t c) const
+    {
+      if (_bytes == 1 && step == 1) { memset(d, c, len); return; }
+      std::int32_t add = step * _bytes;
+      do
+      {
+        memcpy(d, &c, _bytes);
+        d += add;
+      } while (--len);
+    }
+
+    void put_run(std::uint8_t* d, std::int32_t step, const std::uint8_t* s, std::uint32_t len) const
+    {
+      if (step == 1) { memcpy(d, s, len * _bytes); return; }
+      std::int32_t add = step * _bytes;
+      do
+      {
+        memcpy(d, s, _bytes);
+        s += _bytes;
+        d += add;
+      } while (--len);
+    }
+
+    /// n pixels of row y into dst (buffer format). Pixels outside the tile are 0.
+    void load(std::int32_t x, std::int32_t y, std::uint32_t n, std::uint8_t* dst) const
+    {
+      std::int32_t step;
+      std::uint32_t len = n;
+      std::uint32_t skip = 0;
+      auto s = clip_run(x, y, len, step, &skip);
+      if (s == nullptr) { memset(dst, 0, n * _bytes); return; }
+      if (len != n) { memset(dst, 0, n * _bytes); }
+      dst += skip * _bytes;
+      if (step == 1) { memcpy(dst, s, len * _bytes); return; }
+      std::int32_t add = step * _bytes;
+      do
+      {
+        memcpy(dst, s, _bytes);
+        dst += _bytes;
+        s += add;
+      } while (--len);
+    }
+
+    void advance(std::uint32_t n)
+    {
+      _xpos += n;
+      if (_xpos > _xe)
+      {
+        _xpos = _xs;
+        if (++_ypos > _ye) { _ypos = _ys; }
+      }
+    }
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
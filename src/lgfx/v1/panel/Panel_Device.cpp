@@ -163,58 +163,72 @@ namespace lgfx
 
 //----------------------------------------------------------------------------
 
+  /// argb8888のrawを1ワードのまま比較してアルファ値による区間を探す。
+  static inline std::uint32_t skip_transparent(const std::uint32_t* s, std::uint32_t i, std::uint32_t w)
+  {
+    while (i != w && s[i] < 0x01000000u) { ++i; }
+    return i;
+  }
+  static inline std::uint32_t skip_visible(const std::uint32_t* s, std::uint32_t i, std::uint32_t w)
+  {
+    while (i != w && s[i] >= 0x01000000u) { ++i; }
+    return i;
+  }
+  /// 完全透明(a==0)と不透明(a==255)は +0x01000000 すると 0x02000000 未満になる
+  static inline std::uint32_t skip_solid(const std::uint32_t* s, std::uint32_t i, std::uint32_t w)
+  {
+    while (i != w && (s[i] + 0x01000000u) < 0x02000000u) { ++i; }
+    return i;
+  }
+  static inline std::uint32_t skip_partial(const std::uint32_t* s, std::uint32_t i, std::uint32_t w)
+  {
+    while (i != w && (s[i] + 0x01000000u) >= 0x02000000u) { ++i; }
+    return i;
+  }
+
   void Panel_Device::writeImageARGB(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, pixelcopy_t* param)
   {
+    /// 半透明区間同士の間隔がこれより短い場合は、まとめて1回のreadRectで読出す
+    static constexpr std::uint32_t readback_gap = 32;
+
     auto src_x = param->src_x;
-    auto buffer = reinterpret_cast<argb8888_t*>(const_cast<void*>(param->src_data));
     auto bytes = param->dst_bits >> 3;
-// ESP_LOGI("LGFX","DEBUG: %d %d", param->dst_bits, bytes);
-    // std::uint8_t* dmabuf = _bus->getFlipBuffer(w * bytes);
-    // memset(dmabuf, 0, w * bytes);
-    // param->fp_copy(dmabuf, 0, w, param);
-    // setWindow(x, y, x + w - 1, y);
-    // writeBytes(dmabuf, w * bytes, true);
-    // return;
     pixelcopy_t pc_read(nullptr, _write_depth, _read_depth);
     pixelcopy_t pc_write(nullptr, _write_depth, _write_depth);
     for (;;)
     {
+      auto s = &static_cast<const std::uint32_t*>(param->src_data)[param->src_x + param->src_y * param->src_bitwidth];
       std::uint8_t* dmabuf = _bus->getDMABuffer((w+1) * bytes);
       pc_write.src_data = dmabuf;
-      std::uint32_t xstart = 0, drawed_x = 0;
-      do
-      {
-        std::uint_fast8_t a = buffer[xstart].a;
-        if (!a)
-        {
-          if (drawed_x < xstart)
-          {
-            param->src_x = drawed_x;
-            param->fp_copy(dmabuf, drawed_x, xstart, param);
 
-            pc_write.src_x = drawed_x;
-            writeImage(x + drawed_x, y, xstart - drawed_x, 1, &pc_write, true);
-          }
-          drawed_x = xstart + 1;
-        }
-        else
+      // 半透明の区間の背景を先に読出しておく
+      std::uint32_t rs = 0, re = 0;
+      std::uint32_t i = skip_solid(s, 0, w);
+      while (i != w)
+      {
+        std::uint32_t j = skip_partial(s, i, w);
+        if (re == 0 || i - re >= readback_gap)
         {
-          while (255 == buffer[xstart].a && ++xstart != w);
-          if (xstart == w) break;
-          std::uint32_t j = xstart;
-          while (++j != w && buffer[j].a && buffer[j].a != 255);
-          readRect(x + xstart, y, j - xstart + 1, 1, &dmabuf[xstart * bytes], &pc_read);
-          if (w == (xstart = j)) break;
+          if (re) { readRect(x + rs, y, re - rs, 1, &dmabuf[rs * bytes], &pc_read); }
+          rs = i;
         }
-      } while (++xstart != w);
-      if (drawed_x < xstart)
-      {
-        param->src_x = drawed_x;
-        param->fp_copy(dmabuf, drawed_x, xstart, param);
+        re = j;
+        i = skip_solid(s, j, w);
+      }
+      if (re) { readRect(x + rs, y, re - rs, 1, &dmabuf[rs * bytes], &pc_read); }
 
-        pc_write.src_x = drawed_x;
-        writeImage(x + drawed_x, y, xstart - drawed_x, 1, &pc_write, true);
+      // 透明でない区間ごとに合成して書込む
+      i = skip_transparent(s, 0, w);
+      while (i != w)
+      {
+        std::uint32_t j = skip_visible(s, i, w);
+        param->src_x = src_x + i;
+        param->fp_copy(dmabuf, i, j, param);
+        pc_write.src_x = i;
+        writeImage(x + i, y, j - i, 1, &pc_write, true);
+        i = skip_transparent(s, j, w);
       }
+
       if (!--h) return;
       param->src_x = src_x;
       param->src_y++;
@@ -224,52 +238,65 @@ namespace lgfx
 
   void Panel_Device::copyRect(std::uint_fast16_t dst_x, std::uint_fast16_t dst_y, std::uint_fast16_t w, std::uint_fast16_t h, std::uint_fast16_t src_x, std::uint_fast16_t src_y)
   {
-    pixelcopy_t pc_read( (void*)nullptr, _write_depth, _read_depth);
-    pixelcopy_t pc_write((void*)nullptr, _write_depth, _write_depth);
     std::size_t write_bytes = (_write_depth + 7) >> 3;
-    startWrite();
 
-    auto dir = get_fastread_dir();
-    if (dir == fastread_dir_t::fastread_vertical
-    || (dir == fastread_dir_t::fastread_nothing && (w < h)))
-    {
-      const std::uint32_t buflen = h * write_bytes;
-      std::uint8_t buf[buflen];
-      pc_write.src_data = buf;
-      pc_write.src_width = 1;
-      pc_write.src_bitwidth = 1;
-      std::int32_t add = (src_x < dst_x) ?   - 1 : 1;
-      std::int32_t pos = (src_x < dst_x) ? w - 1 : 0;
-      do {
-        readRect(src_x + pos, src_y, 1, h, buf, &pc_read);
-        pc_write.src_x = 0;
-        pc_write.src_y = 0;
-        writeImage(dst_x + pos, dst_y, 1, h, &pc_write, true);
-        //setWindow(dst_x + pos, dst_y, dst_x + pos, dst_y);
-        //writePixels(&pc_write, h);
-        pos += add;
-      } while (--w);
-      waitDMA();
-    }
-    else
+    bool vertical = (get_fastread_dir() == fastread_dir_t::fastread_vertical);
+
+    // 1ライン(縦方向の場合は1列)ずつではなく、バッファに収まるだけのライン数をまとめて読み書きする
+    std::size_t line_bytes = (vertical ? h : w) * write_bytes;
+    std::uint32_t lines = vertical ? w : h;
+    std::uint32_t block = std::min<std::uint32_t>(lines, std::max<std::size_t>(1, _copy_buffer_size / line_bytes));
+
+    ScratchArena::checkpoint_t cp(&_scratch);
+    auto buf = static_cast<std::uint8_t*>(_scratch.allocate(block * line_bytes));
+    if (buf == nullptr && block > 1)
     {
-      const std::uint32_t buflen = w * write_bytes;
-      std::uint8_t buf[buflen];
-      pc_write.src_data = buf;
-      std::int32_t add = (src_y < dst_y) ?   - 1 : 1;
-      std::int32_t pos = (src_y < dst_y) ? h - 1 : 0;
-      do {
-        readRect(src_x, src_y + pos, w, 1, buf, &pc_read);
-        pc_write.src_x = 0;
-        pc_write.src_y = 0;
-        writeImage(dst_x, dst_y + pos, w, 1, &pc_write, true);
-        pos += add;
-      } while (--h);
-      waitDMA();
+      block = 1;
+      buf = static_cast<std::uint8_t*>(_scratch.allocate(line_bytes));
     }
+    if (buf == nullptr) return;
+
+    startWrite();
+    copy_rect_block(dst_x, dst_y, w, h, src_x, src_y, buf, block, vertical);
+    waitDMA();
     endWrite();
   }
 
+  void Panel_Device::copy_rect_block(std::uint_fast16_t dst_x, std::uint_fast16_t dst_y, std::uint_fast16_t w, std::uint_fast16_t h, std::uint_fast16_t src_x, std::uint_fast16_t src_y, std::uint8_t* buf, std::uint32_t block, bool vertical)
+  {
+    pixelcopy_t pc_read( (void*)nullptr, _write_depth, _read_depth);
+    pixelcopy_t pc_write((void*)nullptr, _write_depth, _write_depth);
+    pc_write.src_data = buf;
+
+    // 転送元と転送先が重なっている場合に備え、転送先の側から順に処理する
+    std::uint32_t lines = vertical ? w : h;
+    bool reverse = vertical ? (src_x < dst_x) : (src_y < dst_y);
+    std::uint32_t pos = reverse ? lines : 0;
+    do
+    {
+      std::uint32_t len = std::min(block, lines);
+      lines -= len;
+      if (reverse) { pos -= len; }
+      pc_write.src_x = 0;
+      pc_write.src_y = 0;
+      if (vertical)
+      {
+        pc_write.src_width = len;
+        pc_write.src_bitwidth = len;
+        readRect(src_x + pos, src_y, len, h, buf, &pc_read);
+        writeImage(dst_x + pos, dst_y, len, h, &pc_write, true);
+      }
+      else
+      {
+        pc_write.src_width = w;
+        pc_write.src_bitwidth = w;
+        readRect(src_x, src_y + pos, w, len, buf, &pc_read);
+        writeImage(dst_x, dst_y + pos, w, len, &pc_write, true);
+      }
+      if (!reverse) { pos += len; }
+    } while (lines);
+  }
+
 //----------------------------------------------------------------------------
 
   void Panel_Device::init_cs(void)
@@ -430,6 +457,21 @@ namespace lgfx
   {
     if (_touch == nullptr) return 0;
 
+    if (_touch_task)
+    { // the task owns the touch, return its last filtered sample instead of reading the bus again.
+      std::uint32_t sample = _touch_sample.load(std::memory_order_acquire);
+      if (sample == ~0u) return 0;
+      tp->x = (std::int16_t)sample;
+      tp->y = (std::int16_t)(sample >> 16);
+      tp->id = 0;
+      tp->size = 1;
+      return 1;
+    }
+    return read_touch_raw(tp, number);
+  }
+
+  std::uint_fast8_t Panel_Device::read_touch_raw(touch_point_t* tp, std::int_fast8_t number)
+  {
     bool need_transaction = (getStartCount() && _touch->config().bus_shared);
     if (need_transaction) { endTransaction(); }
     auto res = _touch->getTouchRaw(tp, number);
@@ -444,6 +486,107 @@ namespace lgfx
     return res;
   }
 
+  static std::int32_t median3(const std::int32_t* v)
+  {
+    std::int32_t a = v[0], b = v[1], c = v[2];
+    if (a > b) std::swap(a, b);
+    if (b > c) std::swap(b, c);
+    return (a > b) ? a : b;
+  }
+
+  bool Panel_Device::sampleTouch(void)
+  {
+    if (_touch == nullptr) return false;
+    touch_point_t tp;
+    bool touched = read_touch_raw(&tp, 1);
+    auto& f = _touch_filter;
+
+    touch_event_t ev;
+    ev.msec = lgfx::millis();
+    if (!touched)
+    {
+      if (f.touched)
+      {
+        f.touched = false;
+        _touch_sample.store(~0u, std::memory_order_release);
+        ev.x = f.last_x;
+        ev.y = f.last_y;
+        ev.state = touch_end;
+        _touch_events.push(ev);
+      }
+      return false;
+    }
+
+    std::int32_t rx = tp.x;
+    std::int32_t ry = tp.y;
+    if (!f.touched)
+    {
+      f.count = 0;
+      f.hist_idx = 0;
+      f.iir_x = rx << 4;
+      f.iir_y = ry << 4;
+    }
+    f.hist_x[f.hist_idx] = rx;
+    f.hist_y[f.hist_idx] = ry;
+    if (++f.hist_idx == 3) { f.hist_idx = 0; }
+    if (f.count < 3) { ++f.count; }
+    if (f.median && f.count >= 3)
+    {
+      rx = median3(f.hist_x);
+      ry = median3(f.hist_y);
+    }
+    if (f.iir_shift)
+    {
+      f.iir_x += ((rx << 4) - f.iir_x) >> f.iir_shift;
+      f.iir_y += ((ry << 4) - f.iir_y) >> f.iir_shift;
+      rx = (f.iir_x + 8) >> 4;
+      ry = (f.iir_y + 8) >> 4;
+    }
+    _touch_sample.store((std::uint16_t)rx | (std::uint32_t)(std::uint16_t)ry << 16, std::memory_order_release);
+    convertRawXY(&rx, &ry);
+
+    ev.x = rx;
+    ev.y = ry;
+    ev.id = tp.id;
+    ev.size = tp.size;
+    if (!f.touched)
+    {
+      f.touched = true;
+      ev.state = touch_begin;
+    }
+    else
+    {
+      if (rx == f.last_x && ry == f.last_y) { return true; }
+      ev.state = touch_move;
+    }
+    f.last_x = rx;
+    f.last_y = ry;
+    _touch_events.push(ev);
+    return true;
+  }
+
+  static bool touch_task_cb(void* arg)
+  {
+    return ((Panel_Device*)arg)->sampleTouch();
+  }
+
+  bool Panel_Device::startTouchTask(std::uint32_t interval_ms, std::int_fast8_t core)
+  {
+    if (_touch == nullptr || _touch_task) return false;
+    auto cfg = _touch->config();
+    if (cfg.bus_shared) return false;
+    _touch_task = startSamplingTask(touch_task_cb, this, cfg.pin_int, interval_ms, core);
+    return _touch_task != nullptr;
+  }
+
+  void Panel_Device::stopTouchTask(void)
+  {
+    if (_touch_task == nullptr) return;
+    stopSamplingTask(_touch_task);
+    _touch_task = nullptr;
+    _touch_sample.store(~0u, std::memory_order_relaxed);
+  }
+
 //----------------------------------------------------------------------------
 
  }
@@ -18,6 +18,8 @@ Contributors:
 #pragma once
 
 #include "../Panel.hpp"
+#include "../Touch.hpp"
+#include "../misc/scratch_arena.hpp"
 
 namespace lgfx
 {
@@ -26,9 +28,6 @@ namespace lgfx
 //----------------------------------------------------------------------------
   struct IBus;
   struct ILight;
-  struct ITouch;
-  struct touch_point_t;
-
   class Panel_Device : public IPanel
   {
   public:
@@ -136,6 +135,31 @@ namespace lgfx
     void setCalibrateAffine(float affine[6]);
     void setCalibrate(std::uint16_t *parameters);
 
+    /// Read the touch once, filter it and queue begin / move / end events. Returns true while touched.
+    /// Call it either from the draw loop or via startTouchTask, not both.
+    /// タッチを1回読み取りフィルタを掛けてイベントをキューに積む。タッチ中はtrueを返す。
+    /// 描画ループから直接呼ぶか startTouchTask を使うか、どちらか一方にすること。
+    bool sampleTouch(void);
+
+    /// Take one event out of the queue. Returns false when the queue is empty.
+    /// キューからイベントを1件取り出す。空の場合はfalseを返す
+    bool getTouchEvent(touch_event_t* ev) { return _touch_events.pop(ev); }
+    std::size_t getTouchEventCount(void) const { return _touch_events.size(); }
+    void clearTouchEvents(void) { _touch_events.clear(); }
+
+    /// median : 3-sample median filter to remove spikes.  iir_shift : smoothing strength (0=off, new = old + (raw - old) >> iir_shift)
+    /// median : 3サンプルのメディアンフィルタでスパイクを除去する  iir_shift : 平滑化の強さ (0=無効)
+    void setTouchFilter(bool median, std::uint8_t iir_shift) { _touch_filter.median = median; _touch_filter.iir_shift = iir_shift; }
+
+    /// Sample the touch on a background task. While untouched, the task sleeps until pin_int falls (if configured).
+    /// While it runs, getTouch / getTouchRaw return the last filtered sample of the task (one point) without reading the bus.
+    /// Not available when the touch shares the bus with the panel.
+    /// バックグラウンドタスクでタッチをサンプリングする。非タッチ時は pin_int の立下りまで休止する (設定時)
+    /// 実行中の getTouch / getTouchRaw はバスを読まず、タスクが最後にフィルタした値(1点)を返す
+    /// タッチがパネルとバスを共有している場合は使用できない
+    bool startTouchTask(std::uint32_t interval_ms = 10, std::int_fast8_t core = -1);
+    void stopTouchTask(void);
+
 
     bool isReadable(void) const override { return _cfg.readable; }
     bool isBusShared(void) const override { return _cfg.bus_shared; }
@@ -149,6 +173,15 @@ namespace lgfx
     void writeImageARGB(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, pixelcopy_t* param) override;
     void copyRect(std::uint_fast16_t dst_x, std::uint_fast16_t dst_y, std::uint_fast16_t w, std::uint_fast16_t h, std::uint_fast16_t src_x, std::uint_fast16_t src_y) override;
 
+    /// Size of the work buffer used by copyRect. The larger it is, the more lines are moved per read/write pair.
+    /// copyRectで使用する作業バッファのサイズ。大きいほど1回の読み書きで多くのラインを転送する
+    void setCopyBufferSize(std::size_t size) { _copy_buffer_size = size; }
+    std::size_t getCopyBufferSize(void) const { return _copy_buffer_size; }
+
+    /// Scratch memory for the line buffers of copyRect, writeImage and readRect. peak() reports the largest use.
+    /// copyRect, writeImage, readRectのラインバッファ用の領域。peak()で最大使用量を取得できる
+    ScratchArena* getScratchArena(void) { return &_scratch; }
+
   protected:
 
     static constexpr std::uint8_t CMD_INIT_DELAY = 0x80;
@@ -163,6 +196,30 @@ namespace lgfx
 
     float _affine[6] = {1,0,0,0,1,0};  /// touch affine parameter
 
+    std::size_t _copy_buffer_size = 4096;
+    ScratchArena _scratch;
+
+    struct touch_filter_t
+    {
+      std::int32_t hist_x[3];
+      std::int32_t hist_y[3];
+      std::int32_t iir_x;     /// 1/16 pixel unit
+      std::int32_t iir_y;
+      std::int32_t last_x = -1;
+      std::int32_t last_y = -1;
+      std::uint8_t count = 0; /// number of samples since touch began (up to 3)
+      std::uint8_t hist_idx = 0;
+      std::uint8_t iir_shift = 2;
+      bool median = true;
+      bool touched = false;
+    };
+    touch_filter_t _touch_filter;
+    TouchEventQueue<16> _touch_events;
+    void* _touch_task = nullptr;
+    std::atomic<std::uint32_t> _touch_sample { ~0u };  /// filtered raw x | y << 16 of the task, ~0u : untouched
+
+    std::uint_fast8_t read_touch_raw(touch_point_t* tp, std::int_fast8_t number);
+
     /// Performs preparation processing for the CS pin.
     /// If you want to control the CS pin on your own, override this function and implement it.
     /// CSピンの準備処理を行う。CSピンを自前で制御する場合、この関数をoverrideして実装すること。
@@ -197,6 +254,8 @@ namespace lgfx
 
     void command_list(const std::uint8_t *addr);
 
+    void copy_rect_block(std::uint_fast16_t dst_x, std::uint_fast16_t dst_y, std::uint_fast16_t w, std::uint_fast16_t h, std::uint_fast16_t src_x, std::uint_fast16_t src_y, std::uint8_t* buf, std::uint32_t block, bool vertical);
+
   };
 
 //----------------------------------------------------------------------------
@@ -37,6 +37,8 @@ namespace lgfx
 
     void setWindow(std::uint_fast16_t xs, std::uint_fast16_t ys, std::uint_fast16_t xe, std::uint_fast16_t ye) override
     {
+      // the cursor of the shadow restarts even when the window is unchanged, as RAMWR does on the panel.
+      _shadow.setWindow(xs, ys, xe, ye);
       if (xs != _xs || xe != _xe || ys != _ys || ye != _ye)
       {
         if (_internal_rotation & 1)
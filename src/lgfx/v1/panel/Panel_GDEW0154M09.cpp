@@ -38,6 +38,7 @@ namespace lgfx
   Panel_GDEW0154M09::~Panel_GDEW0154M09(void)
   {
     if (_buf) heap_free(_buf);
+    if (_shadow) heap_free(_shadow);
   }
 
   color_depth_t Panel_GDEW0154M09::setColorDepth(color_depth_t depth)
@@ -59,6 +60,9 @@ namespace lgfx
     if (_buf) heap_free(_buf);
     _buf = static_cast<std::uint8_t*>(heap_alloc_dma(len));
     memset(_buf, 255, len);
+    if (_shadow) heap_free(_shadow);
+    _shadow = static_cast<std::uint8_t*>(heap_alloc_dma(len));
+    memcpy(_shadow, _buf, len);
 
     _wait_busy();
 
@@ -73,13 +77,14 @@ namespace lgfx
 
     setRotation(_rotation);
 
-    _range_old.top = 0;
-    _range_old.left = 0;
-    _range_old.right = _width - 1;
-    _range_old.bottom = _height - 1;
-    _exec_transfer(0x13, _range_old);
-    _close_transfer();
-    _range_new = _range_old;
+    _range_new.top = 0;
+    _range_new.left = 0;
+    _range_new.right = _cfg.panel_width - 1;
+    _range_new.bottom = _cfg.panel_height - 1;
+    _exec_transfer(0x13, _range_new, _buf);
+    _exec_transfer(0x10, _range_new, _buf);
+    _bus->wait();
+    _full_refresh = true;  // the panel content is unknown, the first display() refreshes the whole screen.
 
     endWrite();
 
@@ -118,28 +123,54 @@ namespace lgfx
       _range_new.bottom = std::max<std::int16_t>(_range_new.bottom, y + h - 1);
     }
     if (_range_new.empty()) { return; }
-    _close_transfer();
-    _range_old = _range_new;
+
+    range_rect_t range = _range_new;
+    _range_new.top    = INT16_MAX;
+    _range_new.left   = INT16_MAX;
+    _range_new.right  = 0;
+    _range_new.bottom = 0;
+    range.left   = std::max<std::int32_t>(0, range.left) & ~7;
+    range.top    = std::max<std::int32_t>(0, range.top);
+    range.right  = std::min<std::int32_t>(((_cfg.panel_width + 7) & ~7) - 1, range.right) | 7;
+    range.bottom = std::min<std::int32_t>(_cfg.panel_height - 1, range.bottom);
+    if (range.empty()) { return; }
+
+    if (_full_refresh)
+    { // the whole frame is sent, whatever range was requested.
+      _full_refresh = false;
+      range.left   = 0;
+      range.top    = 0;
+      range.right  = ((_cfg.panel_width + 7) & ~7) - 1;
+      range.bottom = _cfg.panel_height - 1;
+    }
+    // only the bytes that differ from the displayed frame are refreshed. nothing changed : no refresh.
+    else if (!_diff_rect(range)) { return; }
+
     while (millis() - _send_msec < _refresh_msec) delay(1);
+    _exec_transfer(0x10, range, _shadow);
     if (getEpdMode() == epd_mode_t::epd_quality)
     {
-      _exec_transfer(0x13, _range_new, true);
+      _exec_transfer(0x13, range, _buf, true);
       _wait_busy();
       _bus->writeCommand(0x12, 8);
       auto send_msec = millis();
       delay(300);
       while (millis() - send_msec < _refresh_msec) delay(1);
-      _exec_transfer(0x10, _range_new, true);
+      _exec_transfer(0x10, range, _buf, true);
     }
-    _exec_transfer(0x13, _range_new);
-    _range_new.top    = INT16_MAX;
-    _range_new.left   = INT16_MAX;
-    _range_new.right  = 0;
-    _range_new.bottom = 0;
+    _exec_transfer(0x13, range, _buf);
 
     _wait_busy();
     _bus->writeCommand(0x12, 8);
     _send_msec = millis();
+
+    std::int32_t add = ((_cfg.panel_width + 7) & ~7) >> 3;
+    std::int32_t len = ((range.right - range.left) >> 3) + 1;
+    std::int32_t idx = range.top * add + (range.left >> 3);
+    for (std::int32_t i = range.top; i <= range.bottom; ++i, idx += add)
+    {
+      memcpy(&_shadow[idx], &_buf[idx], len);
+    }
   }
 
   void Panel_GDEW0154M09::setInvert(bool invert)
@@ -256,7 +287,9 @@ namespace lgfx
     std::uint32_t ys = y, ye = y + h - 1;
     _update_transferred_rect(xs, ys, xe, ye);
 
-    swap565_t readbuf[w];
+    ScratchArena::checkpoint_t cp(&_scratch);
+    auto readbuf = _scratch.allocate_array<swap565_t>(w);
+    if (readbuf == nullptr) return;
     auto sx = param->src_x32;
     h += y;
     do
@@ -352,7 +385,9 @@ namespace lgfx
 
   void Panel_GDEW0154M09::readRect(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, void* dst, pixelcopy_t* param)
   {
-    swap565_t readbuf[w];
+    ScratchArena::checkpoint_t cp(&_scratch);
+    auto readbuf = _scratch.allocate_array<swap565_t>(w);
+    if (readbuf == nullptr) return;
     param->src_data = readbuf;
     std::int32_t readpos = 0;
     h += y;
@@ -412,7 +447,53 @@ namespace lgfx
     return _buf[idx >> 3] & (0x80 >> (idx & 7));
   }
 
-  void Panel_GDEW0154M09::_exec_transfer(std::uint32_t cmd, const range_rect_t& range, bool invert)
+  bool Panel_GDEW0154M09::_diff_rect(range_rect_t& range) const
+  {
+    std::int32_t add = ((_cfg.panel_width + 7) & ~7) >> 3;
+    std::int32_t bx0 = range.left >> 3;
+    std::int32_t bx1 = range.right >> 3;
+    std::int32_t left = INT32_MAX, right = -1, top = -1, bottom = -1;
+    for (std::int32_t y = range.top; y <= range.bottom; ++y)
+    {
+      auto a = &_buf[y * add];
+      auto b = &_shadow[y * add];
+      std::uint32_t wa, wb;
+
+      // first differing byte, compared 4 bytes at a time.
+      std::int32_t i = bx0;
+      for (; i + 3 <= bx1; i += 4)
+      {
+        memcpy(&wa, &a[i], 4);
+        memcpy(&wb, &b[i], 4);
+        if (wa != wb) break;
+      }
+      while (i <= bx1 && a[i] == b[i]) { ++i; }
+      if (i > bx1) continue;
+
+      // last differing byte.
+      std::int32_t j = bx1;
+      for (; j - 3 > i; j -= 4)
+      {
+        memcpy(&wa, &a[j - 3], 4);
+        memcpy(&wb, &b[j - 3], 4);
+        if (wa != wb) break;
+      }
+      while (a[j] == b[j]) { --j; }
+
+      if (top < 0) { top = y; }
+      bottom = y;
+      if (left  > i) { left  = i; }
+      if (right < j) { right = j; }
+    }
+    if (top < 0) { return false; }
+    range.left   = left << 3;
+    range.right  = (right << 3) + 7;
+    range.top    = top;
+    range.bottom = bottom;
+    return true;
+  }
+
+  void Panel_GDEW0154M09::_exec_transfer(std::uint32_t cmd, const range_rect_t& range, const std::uint8_t* src, bool invert)
   {
     std::int32_t xs = range.left & ~7;
     std::int32_t xe = range.right & ~7;
@@ -431,48 +512,58 @@ namespace lgfx
 
     _bus->writeCommand(cmd, 8);
     std::int32_t w = ((xe - xs) >> 3) + 1;
-    std::int32_t y = range.top;
+    std::int32_t h = range.bottom - range.top + 1;
     std::int32_t add = ((_cfg.panel_width + 7) & ~7) >> 3;
-    auto b = &_buf[xs >> 3];
-    if (invert)
+    auto b = &src[(xs >> 3) + range.top * add];
+    if (!invert && w == add)
+    { // full width rows are contiguous in the buffer.
+      _bus->writeBytes(b, w * h, true, true);
+      return;
+    }
+
+    // pack the rows (inverted if required) into DMA buffers and send them in bulk.
+    std::int32_t rows = std::max<std::int32_t>(1, _transfer_chunk / w);
+    do
     {
-      b += y * add;
-      do
+      std::int32_t n = std::min(rows, h);
+      h -= n;
+      auto dst = _bus->getDMABuffer(n * w);
+      if (dst == nullptr)
       {
-        std::int32_t i = 0;
         do
         {
-          _bus->writeData(~b[i], 8);
-        } while (++i != w);
-        b += add;
-      } while (++y <= range.bottom);
-    }
-    else
-    {
+          if (invert)
+          {
+            std::int32_t i = 0;
+            do
+            {
+              _bus->writeData(~b[i], 8);
+            } while (++i != w);
+          }
+          else
+          {
+            _bus->writeBytes(b, w, true, true);
+          }
+          b += add;
+        } while (--n);
+        continue;
+      }
+      auto d = dst;
       do
       {
-        _bus->writeBytes(&b[add * y], w, true, true);
-      } while (++y <= range.bottom);
-    }
-    /*
-    range->top = INT_MAX;
-    range->left = INT_MAX;
-    range->right = 0;
-    range->bottom = 0;
-    //*/
-  }
-
-  void Panel_GDEW0154M09::_close_transfer(void)
-  {
-    if (_range_old.empty()) { return; }
-    while (millis() - _send_msec < _refresh_msec) delay(1);
-    _exec_transfer(0x10, _range_old);
-    _range_old.top    = INT16_MAX;
-    _range_old.left   = INT16_MAX;
-    _range_old.right  = 0;
-    _range_old.bottom = 0;
-
-    _bus->wait();
+        if (invert)
+        {
+          for (std::int32_t i = 0; i < w; ++i) { d[i] = ~b[i]; }
+        }
+        else
+        {
+          memcpy(d, b, w);
+        }
+        d += w;
+        b += add;
+      } while (--n);
+      _bus->writeBytes(dst, d - dst, true, true);
+    } while (h);
   }
 
   void Panel_GDEW0154M09::_update_transferred_rect(std::uint32_t &xs, std::uint32_t &ys, std::uint32_t &xe, std::uint32_t &ye)
@@ -498,10 +589,6 @@ namespace lgfx
     std::int32_t x1 = xs & ~7;
     std::int32_t x2 = (xe & ~7) + 7;
 
-    if (_range_old.horizon.intersectsWith(x1, x2) && _range_old.vertical.intersectsWith(ys, ye))
-    {
-      _close_transfer();
-    }
     _range_new.top    = std::min<std::int32_t>(ys, _range_new.top);
     _range_new.left   = std::min<std::int32_t>(x1, _range_new.left);
     _range_new.right  = std::max<std::int32_t>(x2, _range_new.right);
@@ -61,19 +61,21 @@ namespace lgfx
   private:
 
     static constexpr unsigned long _refresh_msec = 320;
+    static constexpr std::int32_t _transfer_chunk = 512;
     std::uint8_t* _buf = nullptr;
+    std::uint8_t* _shadow = nullptr;  // frame shown on the panel
 
     range_rect_t _range_new;
-    range_rect_t _range_old;
     std::int32_t _xpos = 0;
     std::int32_t _ypos = 0;
     unsigned long _send_msec = 0;
+    bool _full_refresh = false;
 
     bool _wait_busy(std::uint32_t timeout = 1000);
     void _draw_pixel(std::int32_t x, std::int32_t y, std::uint32_t value);
     bool _read_pixel(std::int32_t x, std::int32_t y);
-    void _exec_transfer(std::uint32_t cmd, const range_rect_t& range, bool invert = false);
-    void _close_transfer(void);
+    bool _diff_rect(range_rect_t& range) const;
+    void _exec_transfer(std::uint32_t cmd, const range_rect_t& range, const std::uint8_t* src, bool invert = false);
     void _update_transferred_rect(std::uint32_t &xs, std::uint32_t &ys, std::uint32_t &xe, std::uint32_t &ye);
 
     const std::uint8_t* getInitCommands(std::uint8_t listno) const override
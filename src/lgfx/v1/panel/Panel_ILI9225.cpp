@@ -64,6 +64,7 @@ namespace lgfx
 
   void Panel_ILI9225::setWindow(std::uint_fast16_t xs, std::uint_fast16_t ys, std::uint_fast16_t xe, std::uint_fast16_t ye)
   {
+    _shadow.setWindow(xs, ys, xe, ye);
     set_window(xs, ys, xe, ye, CMD_RAMWR);
   }
 
@@ -74,6 +75,7 @@ namespace lgfx
 
     set_window(x, y, x, y, CMD_RAMWR);
     _bus->writeData(rawcolor, _write_bits);
+    _shadow.fill(x, y, 1, 1, rawcolor);
 
     if (!tr) end_transaction();
   }
@@ -85,6 +87,7 @@ namespace lgfx
     std::uint_fast16_t ye = y + h - 1;
     set_window(x, y, xe, ye, CMD_RAMWR);
     _bus->writeDataRepeat(rawcolor, _write_bits, len);
+    _shadow.fill(x, y, w, h, rawcolor);
   }
 
   color_depth_t Panel_ILI9225::setColorDepth(color_depth_t depth)
@@ -92,6 +95,7 @@ namespace lgfx
     setColorDepth_impl(depth);
     _write_bits = _write_depth & color_depth_t::bit_mask;
     _read_bits = _read_depth & color_depth_t::bit_mask;
+    _shadow.setDepth(_write_depth, _read_depth);
 
     update_madctl();
     return _write_depth;
@@ -111,6 +115,7 @@ namespace lgfx
     _rowstart = _cfg.offset_y;
 
     _xs = _xe = _ys = _ye = INT16_MAX;
+    _shadow.setRotation(_internal_rotation);
 
     update_madctl();
   }
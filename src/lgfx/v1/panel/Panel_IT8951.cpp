@@ -488,7 +488,8 @@ IT8951 Registers defines
 
   void Panel_IT8951::writeImage(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, pixelcopy_t* param, bool use_dma)
   {
-    std::uint16_t* writebuf = static_cast<std::uint16_t*>(heap_alloc(w * sizeof(bgr888_t) + 4));
+    ScratchArena::checkpoint_t cp(&_scratch);
+    std::uint16_t* writebuf = static_cast<std::uint16_t*>(_scratch.allocate(w * sizeof(bgr888_t) + 4));
     bgr888_t* readbuf = reinterpret_cast<lgfx::bgr888_t*>(&writebuf[2]);
 
     if (writebuf == nullptr) return;
@@ -568,7 +569,6 @@ IT8951 Registers defines
       param->src_y += add_y;
       ++y;
     } while (--h);
-    heap_free(writebuf);
     if (flg_setarea)
     {
       _write_command(IT8951_TCON_LD_IMG_END);
@@ -608,7 +608,8 @@ IT8951 Registers defines
     std::uint32_t w;
 
     std::uint32_t maxw = std::min(length, xe - xs + 1);
-    bgr888_t* readbuf = static_cast<bgr888_t*>(heap_alloc(maxw * sizeof(bgr888_t)));
+    ScratchArena::checkpoint_t cp(&_scratch);
+    auto readbuf = _scratch.allocate_array<bgr888_t>(maxw);
     if (readbuf == nullptr) return;
     do
     {
@@ -662,8 +663,6 @@ IT8951 Registers defines
     } while (length -= w);
     _xpos = xpos;
     _ypos = ypos;
-
-    heap_free(readbuf);
   }
 
   bool Panel_IT8951::_read_raw_line(std::int32_t raw_x, std::int32_t raw_y, std::int32_t len, std::uint16_t* buf)
@@ -720,8 +719,10 @@ IT8951 Registers defines
 
     std::int32_t adjust_left = (rx & 3);
     std::uint32_t padding_len = (adjust_left + rw + 31) & ~31;
-    auto readbuf = static_cast<std::uint8_t*>(heap_alloc(std::max(padding_len, rw * param->dst_bits >> 3)));
-    auto colorbuf = static_cast<bgr888_t*>(heap_alloc(rw * sizeof(bgr888_t)));
+    ScratchArena::checkpoint_t cp(&_scratch);
+    auto readbuf = _scratch.allocate_array<std::uint8_t>(std::max(padding_len, rw * param->dst_bits >> 3));
+    auto colorbuf = _scratch.allocate_array<bgr888_t>(rw);
+    if (readbuf == nullptr || colorbuf == nullptr) return;
 
     param->src_data = colorbuf;
 
@@ -769,9 +770,6 @@ IT8951 Registers defines
       ++ry;
     } while (--rh);
     cs_control(true);
-
-    heap_free(colorbuf);
-    heap_free(readbuf);
   }
 
 //----------------------------------------------------------------------------
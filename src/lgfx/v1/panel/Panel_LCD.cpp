@@ -112,6 +112,7 @@ namespace lgfx
     setColorDepth_impl(depth);
     _write_bits = _write_depth & color_depth_t::bit_mask;
     _read_bits = _read_depth & color_depth_t::bit_mask;
+    _shadow.setDepth(_write_depth, _read_depth);
 
     update_madctl();
 
@@ -145,6 +146,7 @@ namespace lgfx
               ? mh - (ph + oy) : oy;
 
     _xs = _xe = _ys = _ye = INT16_MAX;
+    _shadow.setRotation(_internal_rotation);
 
     update_madctl();
   }
@@ -211,6 +213,7 @@ namespace lgfx
 
   void Panel_LCD::setWindow(std::uint_fast16_t xs, std::uint_fast16_t ys, std::uint_fast16_t xe, std::uint_fast16_t ye)
   {
+    _shadow.setWindow(xs, ys, xe, ye);
     if (!_cfg.dlen_16bit)
     {
       set_window_8(xs, ys, xe, ye, CMD_RAMWR);
@@ -229,6 +232,7 @@ namespace lgfx
     setWindow(x,y,x,y);
     if (_cfg.dlen_16bit) { _align_data = (_write_bits & 15); }
     _bus->writeData(rawcolor, _write_bits);
+    _shadow.fill(x, y, 1, 1, rawcolor);
 
     if (!tr) end_transaction();
   }
@@ -242,11 +246,13 @@ namespace lgfx
     setWindow(x,y,xe,ye);
     if (_cfg.dlen_16bit) { _align_data = (_write_bits & 15) && (len & 1); }
     _bus->writeDataRepeat(rawcolor, _write_bits, len);
+    _shadow.fill(x, y, w, h, rawcolor);
   }
 
   void Panel_LCD::writeBlock(std::uint32_t rawcolor, std::uint32_t len)
   {
     _bus->writeDataRepeat(rawcolor, _write_bits, len);
+    _shadow.writeBlock(rawcolor, len);
     if (_cfg.dlen_16bit && (_write_bits & 15) && (len & 1))
     {
       _align_data = !_align_data;
@@ -255,6 +261,7 @@ namespace lgfx
 
   void Panel_LCD::writePixels(pixelcopy_t* param, std::uint32_t len)
   {
+    if (_shadow.valid()) { write_shadow_pixels(param, len); }
     _bus->writePixels(param, len);
     if (_cfg.dlen_16bit && (_write_bits & 15) && (len & 1))
     {
@@ -264,6 +271,8 @@ namespace lgfx
 
   void Panel_LCD::writeImage(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, pixelcopy_t* param, bool use_dma)
   {
+    if (_shadow.valid()) { write_shadow_image(x, y, w, h, param); }
+
     auto bytes = param->dst_bits >> 3;
     auto src_x = param->src_x;
 
@@ -275,6 +284,11 @@ namespace lgfx
         std::uint32_t i = (src_x + param->src_y * param->src_bitwidth) * bytes;
         auto src = &((const std::uint8_t*)param->src_data)[i];
         setWindow(x, y, x + w - 1, y + h - 1);
+        if (_bounce_buffer_size && wb * h > 64 && !heap_capable_dma(src))
+        { // the source is not DMA capable (e.g. PSRAM sprite).
+          write_bounce(src, wb, param->src_bitwidth * bytes, h);
+        }
+        else
         if (param->src_bitwidth == w || h == 1)
         {
           write_bytes(src, wb * h, use_dma);
@@ -337,20 +351,32 @@ namespace lgfx
         }
         else
 //*/
-        {
+        { // rows are converted into strips, one strip is converted while the previous one is sent.
           std::size_t wb = w * bytes;
-          auto buf = _bus->getDMABuffer(wb);
-          param->fp_copy(buf, 0, w, param);
+          // a constant length keeps the DMA buffers of the bus from being reallocated.
+          std::uint32_t len = std::max<std::uint32_t>(_bounce_buffer_size, wb);
+          std::uint32_t rows = len / wb;
           setWindow(x, y, x + w - 1, y + h - 1);
-          write_bytes(buf, wb, true);
-          while (--h)
+          do
           {
-            param->src_x = src_x;
-            param->src_y++;
-            buf = _bus->getDMABuffer(wb);
-            param->fp_copy(buf, 0, w, param);
-            write_bytes(buf, wb, true);
-          }
+            auto buf = _bus->getDMABuffer(len);
+            if (buf == nullptr)
+            { // out of DMA capable memory, the rest is converted in small chunks and sent directly.
+              write_image_direct(w, h, param, bytes);
+              return;
+            }
+            std::uint32_t n = std::min<std::uint32_t>(rows, h);
+            h -= n;
+            std::uint32_t pos = 0;
+            do
+            {
+              param->fp_copy(buf, pos, pos + w, param);
+              pos += w;
+              param->src_x = src_x;
+              param->src_y++;
+            } while (--n);
+            write_bytes(buf, pos * bytes, true);
+          } while (h);
         }
       }
     }
@@ -375,6 +401,60 @@ namespace lgfx
     }
   }
 
+  void Panel_LCD::write_bounce(const std::uint8_t* src, std::uint32_t wb, std::uint32_t add, std::uint32_t h)
+  {
+    // strips of a constant length keep the DMA buffers of the bus from being reallocated.
+    std::uint32_t strip = _bounce_buffer_size;
+    std::uint32_t col = 0;
+    do
+    {
+      auto buf = _bus->getDMABuffer(strip);
+      if (buf == nullptr)
+      { // out of DMA capable memory, the rest is sent directly.
+        do
+        {
+          write_bytes(&src[col], wb - col, false);
+          col = 0;
+          src += add;
+        } while (--h);
+        return;
+      }
+      std::uint32_t len = 0;
+      do
+      {
+        std::uint32_t n = std::min(wb - col, strip - len);
+        memcpy(&buf[len], &src[col], n);
+        len += n;
+        if (wb == (col += n))
+        {
+          col = 0;
+          src += add;
+          --h;
+        }
+      } while (len != strip && h);
+      write_bytes(buf, len, true);
+    } while (h);
+  }
+
+  void Panel_LCD::write_image_direct(std::uint32_t w, std::uint32_t h, pixelcopy_t* param, std::uint32_t bytes)
+  {
+    auto src_x = param->src_x;
+    std::uint32_t buf[48];  // 64 pixels of up to 3 bytes
+    do
+    {
+      std::uint32_t pos = 0;
+      do
+      {
+        std::uint32_t n = std::min<std::uint32_t>(w - pos, 64);
+        param->fp_copy(buf, 0, n, param);
+        write_bytes(reinterpret_cast<std::uint8_t*>(buf), n * bytes, false);
+        pos += n;
+      } while (pos != w);
+      param->src_x = src_x;
+      param->src_y++;
+    } while (--h);
+  }
+
   void Panel_LCD::write_bytes(const std::uint8_t* data, std::uint32_t len, bool use_dma)
   {
     _bus->writeBytes(data, len, true, use_dma);
@@ -384,7 +464,106 @@ namespace lgfx
     }
   }
 
+  void Panel_LCD::write_shadow_pixels(const pixelcopy_t* param, std::uint32_t len)
+  {
+    // the pixels are converted once more from a copy of param, the original is consumed by the bus.
+    pixelcopy_t pc = *param;
+    std::uint32_t buf[48];  // 64 pixels of up to 3 bytes
+    do
+    {
+      std::uint32_t n = std::min<std::uint32_t>(len, 64);
+      pc.fp_copy(buf, 0, n, &pc);
+      _shadow.writePixels(buf, n);
+      len -= n;
+    } while (len);
+  }
+
+  void Panel_LCD::write_shadow_image(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, const pixelcopy_t* param)
+  {
+    pixelcopy_t pc = *param;
+    auto src_x = pc.src_x;
+    std::uint32_t buf[48];  // 64 pixels of up to 3 bytes
+    h += y;
+    do
+    {
+      std::uint32_t i = 0;
+      while (w != (i = (pc.transp == pixelcopy_t::NON_TRANSP) ? i : pc.fp_skip(i, w, &pc)))
+      {
+        std::uint32_t len = pc.fp_copy(buf, 0, std::min<std::uint32_t>(w - i, 64), &pc);
+        _shadow.setWindow(x + i, y, x + i + len - 1, y);
+        _shadow.writePixels(buf, len);
+        i += len;
+      }
+      pc.src_x = src_x;
+      pc.src_y++;
+    } while (++y != h);
+  }
+
+  bool Panel_LCD::initShadowBuffer(color_depth_t depth, bool psram, std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h)
+  {
+    if (!_shadow.create(_cfg.panel_width, _cfg.panel_height, depth, psram, x, y, w, h))
+    {
+      return false;
+    }
+    _shadow.setRotation(_internal_rotation);
+    _shadow.setDepth(_write_depth, _read_depth);
+
+    if (_cfg.readable && _bus != nullptr)
+    { // start from the current panel content.
+      std::uint32_t buf[48];  // 64 pixels of up to 3 bytes
+      pixelcopy_t pc_read(nullptr, _write_depth, _read_depth);
+      for (std::uint_fast16_t i = 0; i < _height; ++i)
+      {
+        for (std::uint_fast16_t j = 0; j < _width; j += 64)
+        {
+          std::uint_fast16_t n = std::min<std::uint_fast16_t>(_width - j, 64);
+          read_rect(j, i, n, 1, buf, &pc_read);
+          _shadow.setWindow(j, i, j + n - 1, i);
+          _shadow.writePixels(buf, n);
+        }
+      }
+    }
+    return true;
+  }
+
   void Panel_LCD::readRect(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, void* dst, pixelcopy_t* param)
+  {
+    if (!_shadow.covers(x, y, w, h))
+    {
+      read_rect(x, y, w, h, dst, param);
+      return;
+    }
+
+    if (param->no_convert)
+    {
+      auto d = static_cast<std::uint8_t*>(dst);
+      std::size_t wb = w * (param->dst_bits >> 3);
+      do
+      {
+        _shadow.readRow(x, y++, w, d);
+        d += wb;
+      } while (--h);
+    }
+    else
+    {
+      std::uint32_t buf[48];  // 64 pixels of up to 3 bytes
+      param->src_data = buf;
+      std::int32_t readpos = 0;
+      do
+      {
+        for (std::uint_fast16_t i = 0; i < w; i += 64)
+        {
+          std::uint_fast16_t n = std::min<std::uint_fast16_t>(w - i, 64);
+          _shadow.readRow(x + i, y, n, buf);
+          param->src_x32 = 0;
+          readpos = param->fp_copy(dst, readpos, readpos + n, param);
+        }
+        ++y;
+      } while (--h);
+    }
+  }
+
+  void Panel_LCD::read_rect(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, void* dst, pixelcopy_t* param)
   {
     std::uint_fast16_t bytes = param->dst_bits >> 3;
     auto len = w * h;
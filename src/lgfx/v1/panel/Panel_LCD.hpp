@@ -18,6 +18,7 @@ Contributors:
 #pragma once
 
 #include "Panel_Device.hpp"
+#include "../misc/shadow_buffer.hpp"
 
 namespace lgfx
 {
@@ -54,6 +55,27 @@ namespace lgfx
     std::uint32_t readData(std::uint_fast8_t index, std::uint_fast8_t len) override;
     void readRect(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, void* dst, pixelcopy_t* param) override;
 
+    /// Keep a copy of the panel memory in RAM (shadow framebuffer), updated by every write. readRect is then served from RAM,
+    /// and a write-only panel becomes readable (anti-aliased fonts, alpha blending, floodFill).
+    /// depth : rgb565_2Byte / rgb888_3Byte, or rgb332_1Byte to save memory at the cost of color precision.
+    /// w,h == 0 : whole panel. Otherwise only the rectangle x,y,w,h (panel memory coordinates, without rotation) is kept.
+    /// パネルメモリの複製をRAM上に保持する(シャドウフレームバッファ)。書込み毎に更新され、readRectはRAMから応答する。
+    /// 読出し不可のパネルも読出し可能になる(アンチエイリアスフォント・半透明合成・floodFill)。
+    /// depth : rgb565_2Byte / rgb888_3Byte 、メモリ節約のため rgb332_1Byte も指定可能(色精度は低下する)
+    /// w,h == 0 : パネル全体。それ以外は矩形 x,y,w,h (回転なしのパネルメモリ座標) のみを保持する
+    bool initShadowBuffer(color_depth_t depth = rgb565_2Byte, bool psram = false, std::uint_fast16_t x = 0, std::uint_fast16_t y = 0, std::uint_fast16_t w = 0, std::uint_fast16_t h = 0);
+    void releaseShadowBuffer(void) { _shadow.release(); }
+    bool hasShadowBuffer(void) const { return _shadow.valid(); }
+
+    bool isReadable(void) const override { return _cfg.readable || _shadow.isFull(); }
+
+    /// Length of the two DMA bounce buffers. writeImage from memory without DMA access (PSRAM) and writeImage with color conversion
+    /// gather rows into strips of this length, one strip is filled while the other is sent. 0 : disabled, rows are sent one by one.
+    /// DMAバウンスバッファ(2面)の長さ。DMAで読めないメモリ(PSRAM)からのwriteImageと色変換を伴うwriteImageは、行をこの長さのストリップにまとめ、
+    /// 一方を送信しながら他方を埋める。0 : 無効、行毎に送信する
+    void setBounceBufferSize(std::size_t size) { _bounce_buffer_size = size; }
+    std::size_t getBounceBufferSize(void) const { return _bounce_buffer_size; }
+
   protected:
 
     std::uint16_t _colstart = 0;
@@ -61,6 +83,8 @@ namespace lgfx
     bool _in_transaction = false;
     std::uint8_t _cmd_nop = CMD_NOP;
     std::uint8_t _cmd_ramrd = CMD_RAMRD;
+    shadow_buffer_t _shadow;
+    std::size_t _bounce_buffer_size = 4096;
 
     enum mad_t
     { MAD_MY  = 0x80
@@ -126,6 +150,11 @@ namespace lgfx
 
     void write_command(std::uint32_t data);
     void write_bytes(const std::uint8_t* data, std::uint32_t len, bool use_dma);
+    void write_bounce(const std::uint8_t* src, std::uint32_t wb, std::uint32_t add, std::uint32_t h);
+    void write_image_direct(std::uint32_t w, std::uint32_t h, pixelcopy_t* param, std::uint32_t bytes);
+    void write_shadow_pixels(const pixelcopy_t* param, std::uint32_t len);
+    void write_shadow_image(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, const pixelcopy_t* param);
+    void read_rect(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, void* dst, pixelcopy_t* param);
     void set_window_8(std::uint_fast16_t xs, std::uint_fast16_t ys, std::uint_fast16_t xe, std::uint_fast16_t ye, std::uint32_t cmd);
     void set_window_16(std::uint_fast16_t xs, std::uint_fast16_t ys, std::uint_fast16_t xe, std::uint_fast16_t ye, std::uint32_t cmd);
 
@@ -66,6 +66,7 @@ namespace lgfx
 
   void Panel_M5UnitLCD::endTransaction(void)
   {
+    _flush_command();
     _bus->endTransaction();
     cs_control(true);
     _last_cmd = 0;
@@ -100,6 +101,9 @@ namespace lgfx
     }
     limit = std::min(255u, limit * 2);
 
+    // 溜めてあるコマンドを送信してからバッファの空きを問い合わせる
+    _flush_command();
+
     std::size_t retry = 16;
     _buff_free_count = 255;
     while (!_bus->writeCommand(CMD_READ_BUFCOUNT, 8) && --retry);
@@ -130,6 +134,25 @@ namespace lgfx
     return false;
   }
 
+  void Panel_M5UnitLCD::_queue_command(const std::uint8_t* buf, std::size_t len)
+  {
+    // 小さなコマンドはまとめて1回の送信で済ませる。
+    // コマンド数は _check_repeat によってユニット側の空きバッファ数以内に抑えられている。
+    if (_cmd_len + len > sizeof(_cmd_buf))
+    {
+      _flush_command();
+    }
+    memcpy(&_cmd_buf[_cmd_len], buf, len);
+    _cmd_len += len;
+  }
+
+  void Panel_M5UnitLCD::_flush_command(void)
+  {
+    if (_cmd_len == 0) return;
+    _bus->writeBytes(_cmd_buf, _cmd_len, false, true);
+    _cmd_len = 0;
+  }
+
   color_depth_t Panel_M5UnitLCD::setColorDepth(color_depth_t depth)
   {
     auto bits = (depth & color_depth_t::bit_mask);
@@ -166,7 +189,9 @@ namespace lgfx
     if (_bus == nullptr) return;
 
     startWrite();
-    _bus->writeCommand(CMD_ROTATE | _internal_rotation << 8, 16);
+    _check_repeat();
+    std::uint8_t buf[2] = { CMD_ROTATE, _internal_rotation };
+    _queue_command(buf, 2);
     endWrite();
   }
 
@@ -175,7 +200,8 @@ namespace lgfx
     _invert = invert;
     startWrite();
     _check_repeat();
-    _bus->writeCommand((invert ^ _cfg.invert) ? CMD_INVON : CMD_INVOFF, 8);
+    std::uint8_t cmd = (invert ^ _cfg.invert) ? CMD_INVON : CMD_INVOFF;
+    _queue_command(&cmd, 1);
     endWrite();
   }
 
@@ -184,7 +210,8 @@ namespace lgfx
     startWrite();
     _check_repeat();
     // true : sleep in  /  false : sleep out
-    _bus->writeCommand(CMD_SET_SLEEP | (flg ? 1 : 0) << 8, 16);
+    std::uint8_t buf[2] = { CMD_SET_SLEEP, (std::uint8_t)(flg ? 1 : 0) };
+    _queue_command(buf, 2);
     endWrite();
   }
 
@@ -193,7 +220,8 @@ namespace lgfx
     startWrite();
     _check_repeat();
     // true : low-power / false : nomal-power
-    _bus->writeCommand(CMD_SET_POWER | (flg ? 0 : 1) << 8, 16);
+    std::uint8_t buf[2] = { CMD_SET_POWER, (std::uint8_t)(flg ? 0 : 1) };
+    _queue_command(buf, 2);
     endWrite();
   }
 
@@ -201,7 +229,8 @@ namespace lgfx
   {
     startWrite();
     _check_repeat();
-    _bus->writeCommand(CMD_BRIGHTNESS | brightness << 8, 16);
+    std::uint8_t buf[2] = { CMD_BRIGHTNESS, brightness };
+    _queue_command(buf, 2);
     endWrite();
   }
 
@@ -243,6 +272,7 @@ namespace lgfx
       }
       length -= len;
     } while (length);
+    _flush_command();
     _bus->writeBytes(buf, idx, false, true);
 //*/
   }
@@ -288,7 +318,7 @@ namespace lgfx
       buf[idx++] = rawcolor;
       rawcolor >>= 8;
     }
-    _bus->writeBytes(buf, idx, false, true);
+    _queue_command(buf, idx);
   }
 
   void Panel_M5UnitLCD::setWindow(std::uint_fast16_t xs, std::uint_fast16_t ys, std::uint_fast16_t xe, std::uint_fast16_t ye)
@@ -328,7 +358,7 @@ namespace lgfx
     if (idx)
     {
       _check_repeat();
-      _bus->writeBytes(buf, idx, false, true);
+      _queue_command(buf, idx);
     }
   }
 
@@ -381,106 +411,154 @@ namespace lgfx
     return res;
   }
 */
-  static std::size_t rleEncode(std::uint8_t* dest, const std::uint8_t* src, std::size_t bytelen, std::size_t bytes)
+  template <std::size_t Bytes>
+  static inline std::uint32_t load_pixel(const std::uint8_t* src)
   {
-/*
-Serial.printf("bytelen:%d bytes:%d\r\n", bytelen, bytes);
-for (int i = 0; i < bytelen; ++i) { Serial.printf("%02x ",src[i]); } Serial.println();
-//*/
-    static constexpr std::size_t maxbyte = 255;
+    std::uint32_t res = src[0];
+    for (std::size_t i = 1; i < Bytes; ++i) { res |= src[i] << (i << 3); }
+    return res;
+  }
+  // 2Byte・4Byteのピクセルは呼出し元で4Byte境界に揃えてあるため、1ピクセルを1回のロードで比較する
+  template <>
+  inline std::uint32_t load_pixel<2>(const std::uint8_t* src) { return *reinterpret_cast<const std::uint16_t*>(src); }
+  template <>
+  inline std::uint32_t load_pixel<4>(const std::uint8_t* src) { return *reinterpret_cast<const std::uint32_t*>(src); }
+
+  /// ピクセル単位で比較するRLEエンコーダ。戻り値はエンコード後のバイト数。
+  /// 圧縮の効果が見込めない場合は途中で打ち切って 0 を返す (呼出し側は無圧縮で送信する)。
+  /// abort_window は dest から src までの距離で、出力がこの範囲に収まっている間は src が破壊されないので打ち切りが可能。
+  template <std::size_t Bytes>
+  static std::size_t rle_encode_impl(std::uint8_t* dest, const std::uint8_t* src, std::size_t length, std::size_t abort_window)
+  {
+    static constexpr std::size_t maxlen = 255;
+    // 絶対モードの区間を分断してまで連続データとして格納する最小の連続数 (分断によるヘッダ増加分より得をする長さ)
+    static constexpr std::size_t min_break = (Bytes == 1) ? 5 : (Bytes == 4) ? 2 : 3;
+    // 1回のループで増える出力量の上限
+    static constexpr std::size_t margin = min_break * Bytes + 3;
+    // 圧縮率の判定を始める入力量
+    static constexpr std::size_t sample_bytes = 64;
 
     std::uint8_t* pdest = dest;
-    const std::uint8_t* pabs = src;
-    const std::uint8_t* prev = src;
- 
-    std::int_fast16_t cont = 1;
-    std::int_fast16_t abso = 0;
-
-    for (std::size_t i = bytes; i < bytelen; i += bytes)
+    std::size_t lit = 0;  // 絶対モードで送る区間の開始位置
+    std::size_t i = 0;
+    bool decided = false;
+    std::uint32_t cur = load_pixel<Bytes>(src);
+    do
     {
-      std::size_t byteidx = 0;
-      while (src[i + byteidx] == src[i + byteidx - bytes] && ++byteidx != bytes);
-
-      if (byteidx == bytes)
+      if (!decided)
       {
-        cont++;
-        if (abso >= 1)
+        std::size_t estimate = (pdest - dest) + (i - lit) * Bytes;
+        std::size_t consumed = i * Bytes;
+        bool limit = estimate + margin > abort_window;
+        if (limit || consumed >= sample_bytes)
         {
-          pdest = store_absolute(pdest, pabs, abso, bytes);
+          // 削減量が1/16未満なら無圧縮で送った方が速い
+          if (estimate * 16 > consumed * 15) return 0;
+          decided = limit;
         }
-        else if (cont == maxbyte)
-        {
-          pdest = store_encoded(pdest, prev, maxbyte, bytes);
-          cont = 1;
-          prev = src + i;
-        }
-        abso = -1;
       }
-      else
+
+      std::size_t j = i;
+      std::uint32_t next;
+      do
       {
-        abso++;
-        if (cont >= 2)
-        {
-          pdest = store_encoded(pdest, prev, cont, bytes);
-        }
-        else if (abso == maxbyte)
+        next = (++j < length) ? load_pixel<Bytes>(&src[j * Bytes]) : ~cur;
+      } while (next == cur && j - i < maxlen);
+
+      std::size_t run = j - i;
+      if (run >= 2 && (lit == i || run >= min_break))
+      {
+        if (lit != i)
         {
-          pdest = store_absolute(pdest, pabs, maxbyte, bytes);
-          abso = 0;
+          pdest = store_absolute(pdest, &src[lit * Bytes], i - lit, Bytes);
         }
-        cont = 1;
-        if (abso == 0) { pabs = src + i; }
-        prev = src + i;
+        pdest = store_encoded(pdest, &src[i * Bytes], run, Bytes);
+        lit = j;
       }
-    }
-     if (abso >= 0)
+      else if (j - lit >= maxlen)
+      {
+        pdest = store_absolute(pdest, &src[lit * Bytes], maxlen, Bytes);
+        lit += maxlen;
+      }
+      i = j;
+      cur = next;
+    } while (i < length);
+
+    if (!decided && ((pdest - dest) + (length - lit) * Bytes) * 16 > length * Bytes * 15)
     {
-      pdest = store_absolute(pdest, pabs, abso + 1, bytes);
+      return 0;
     }
-    else if (cont >= 2)
+    if (lit != length)
     {
-      pdest = store_encoded(pdest, prev, cont, bytes);
+      pdest = store_absolute(pdest, &src[lit * Bytes], length - lit, Bytes);
     }
-/*
-std::size_t res = pdest - dest;
-if (bytelen != rleDecode(dest, res, bytes)*bytes) {
-  Serial.printf("res:%d\r\n", res);
-  for (int i = 0; i < res; ++i) { Serial.printf("%02x ",dest[i]); } Serial.println();
-}
-//*/
     return pdest - dest;
   }
-//*
-  void Panel_M5UnitLCD::writePixels(pixelcopy_t* param, std::uint32_t length)
+
+  static std::size_t rleEncode(std::uint8_t* dest, const std::uint8_t* src, std::size_t length, std::size_t bytes, std::size_t abort_window)
+  {
+    switch (bytes)
+    {
+    case 1:  return rle_encode_impl<1>(dest, src, length, abort_window);
+    case 2:  return rle_encode_impl<2>(dest, src, length, abort_window);
+    case 3:  return rle_encode_impl<3>(dest, src, length, abort_window);
+    default: return rle_encode_impl<4>(dest, src, length, abort_window);
+    }
+  }
+
+  /// 送信用バッファの先頭からピクセルデータ格納位置までの距離。RLEの最悪時の膨張分を確保し、4Byte境界に揃える。
+  static inline std::size_t encode_offset(std::size_t wb)
+  {
+    return ((wb >> 7) + 128 + 3) & ~3u;
+  }
+
+  void Panel_M5UnitLCD::_write_encoded(std::uint8_t* dmabuf, std::size_t offset, std::uint32_t length)
   {
     auto bytes = _write_bits >> 3;
-    std::uint32_t wb = length * bytes;
-    auto dmabuf = _bus->getDMABuffer(wb + (wb >> 7) + 128);
-    dmabuf[0] = CMD_WR_RLE | _write_bits >> 3;
-    std::size_t idx = _check_repeat(dmabuf[0]) ? 0 : 1;
-
-    auto buf = &dmabuf[(wb >> 7) + 128];
-    param->fp_copy(buf, 0, length, param);
-    std::size_t writelen = idx + rleEncode(&dmabuf[idx], buf, length * bytes, bytes);
-    _bus->writeBytes(dmabuf, writelen, false, true);
-    _raw_color = ~0u;
+    std::size_t wb = length * bytes;
+    auto buf = &dmabuf[offset];
+
+    // dmabuf[0]はコマンド用に空けておく
+    std::uint8_t* data = &dmabuf[1];
+    std::size_t len = rleEncode(data, buf, length, bytes, offset - 1);
+    std::uint32_t cmd = CMD_WR_RLE | bytes;
+    if (len)
+    {
+      ++_rle_stats.rle_count;
+    }
+    else
+    {
+      ++_rle_stats.raw_count;
+      data = buf;
+      len = wb;
+      cmd = CMD_WR_RAW | bytes;
+    }
+    _rle_stats.raw_bytes  += wb;
+    _rle_stats.sent_bytes += len;
+    _rle_stats.last_raw_bytes  += wb;
+    _rle_stats.last_sent_bytes += len;
+
+    if (!_check_repeat(cmd))
+    {
+      *--data = cmd;
+      ++len;
+    }
+    _flush_command();
+    _bus->writeBytes(data, len, false, true);
   }
-/*/
+
   void Panel_M5UnitLCD::writePixels(pixelcopy_t* param, std::uint32_t length)
   {
-    auto bytes = _write_bits >> 3;
-    std::uint32_t wb = length * bytes;
-    auto dmabuf = _bus->getDMABuffer(wb + (wb >> 7) + 1);
-    dmabuf[0] = CMD_WR_RAW | _write_bits >> 3;
-    std::size_t idx = _check_repeat(dmabuf[0]) ? 0 : 1;
-
-    auto buf = &dmabuf[idx];
-    param->fp_copy(buf, 0, length, param);
-    std::size_t writelen = idx + wb;
-    _bus->writeBytes(dmabuf, writelen, false, true);
+    _rle_stats.last_raw_bytes = 0;
+    _rle_stats.last_sent_bytes = 0;
+
+    std::uint32_t wb = length * (_write_bits >> 3);
+    std::size_t offset = encode_offset(wb);
+    auto dmabuf = _bus->getDMABuffer(offset + wb);
+    param->fp_copy(&dmabuf[offset], 0, length, param);
+    _write_encoded(dmabuf, offset, length);
     _raw_color = ~0u;
   }
-//*/
 /*
   void Panel_M5UnitLCD::writeImage(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, pixelcopy_t* param, bool use_dma)
   {
@@ -512,21 +590,19 @@ if (bytelen != rleDecode(dest, res, bytes)*bytes) {
 /*/
   void Panel_M5UnitLCD::writeImage(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, pixelcopy_t* param, bool use_dma)
   {
-    // _xs_raw = ~0u;
-    // _ys_raw = ~0u;
+    _rle_stats.last_raw_bytes = 0;
+    _rle_stats.last_sent_bytes = 0;
 
     std::uint32_t sx32 = param->src_x32;
     auto bytes = _write_bits >> 3;
     std::uint32_t y_add = 1;
-    std::uint32_t cmd = CMD_WR_RLE | ((_write_bits >> 3) & 3);
     bool transp = (param->transp != pixelcopy_t::NON_TRANSP);
     if (!transp)
     {
       _set_window(x, y, x+w-1, y+h-1);
-      _check_repeat(cmd);
-      _bus->writeData(cmd, 8);
     }
     std::uint32_t wb = w * bytes;
+    std::size_t offset = encode_offset(wb);
     do
     {
       std::uint32_t i = 0;
@@ -536,21 +612,13 @@ if (bytelen != rleDecode(dest, res, bytes)*bytes) {
         _buff_free_count = (_buff_free_count > sub)
                          ? (_buff_free_count - sub)
                          : 0;
-        auto dmabuf = _bus->getDMABuffer(wb + (wb >> 7) + 128);
-        dmabuf[0] = cmd;
-        auto buf = &dmabuf[(wb >> 7) + 128];
-        std::int32_t len = param->fp_copy(buf, 0, w - i, param);
+        auto dmabuf = _bus->getDMABuffer(offset + wb);
+        std::int32_t len = param->fp_copy(&dmabuf[offset], 0, w - i, param);
         if (transp)
         {
           _set_window(x + i, y, x + i + len - 1, y);
         }
-        if (!_check_repeat(cmd))
-        {
-          _bus->writeData(cmd, 8);
-        }
-        std::size_t idx = 0;
-        std::size_t writelen = rleEncode(&dmabuf[idx], buf, len * bytes, bytes);
-        _bus->writeBytes(dmabuf, writelen, false, true);
+        _write_encoded(dmabuf, offset, len);
         if (w == (i += len)) break;
       }
       param->src_x32 = sx32;
@@ -574,6 +642,7 @@ if (bytelen != rleDecode(dest, res, bytes)*bytes) {
       _check_repeat(0, 255);
     } while (_buff_free_count < 255 && --retry);
     _set_window(x, y, x+w-1, y+h-1);
+    _flush_command();
 
     _bus->writeCommand(CMD_RD_RAW | ((_read_bits >> 3) & 3), 8);
     if (param->no_convert)
@@ -620,7 +689,7 @@ if (bytelen != rleDecode(dest, res, bytes)*bytes) {
 
     startWrite();
     _check_repeat();
-    _bus->writeBytes(buf, idx, false, true);
+    _queue_command(buf, idx);
     endWrite();
   }
 
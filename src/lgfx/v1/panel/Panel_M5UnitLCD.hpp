@@ -63,6 +63,19 @@ namespace lgfx
     std::uint32_t readData(std::uint_fast8_t index, std::uint_fast8_t len) override { return 0; }
     void readRect(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, void* dst, pixelcopy_t* param) override;
 
+    /// writePixels / writeImage で送信したピクセルデータの圧縮統計
+    struct rle_stats_t
+    {
+      std::uint32_t raw_bytes  = 0;       // 圧縮前のデータ量 (累計)
+      std::uint32_t sent_bytes = 0;       // 実際に送信したデータ量 (累計)
+      std::uint32_t rle_count  = 0;       // RLE圧縮で送信した回数
+      std::uint32_t raw_count  = 0;       // 圧縮効果が無いため無圧縮で送信した回数
+      std::uint32_t last_raw_bytes  = 0;  // 直近の呼出しでの圧縮前データ量
+      std::uint32_t last_sent_bytes = 0;  // 直近の呼出しでの送信データ量
+    };
+    const rle_stats_t& getRleStats(void) const { return _rle_stats; }
+    void resetRleStats(void) { _rle_stats = rle_stats_t(); }
+
     static constexpr std::uint8_t CMD_NOP          = 0x00; // 1Byte 何もしない
     static constexpr std::uint8_t CMD_READ_ID      = 0x04; // 1Byte ID読出し  スレーブからの回答は4Byte (0x77 0x89 0x01 0x?? (最後の1バイトはファームウェアバージョン))
     static constexpr std::uint8_t CMD_READ_BUFCOUNT= 0x09; // 1Byte コマンドバッファの空き取得。回答は1Byte
@@ -141,9 +154,15 @@ namespace lgfx
     std::uint32_t _ypos;
     std::uint32_t _last_cmd;
     std::uint32_t _buff_free_count;
+    rle_stats_t _rle_stats;
+    std::uint8_t _cmd_buf[64];    // 送信待ちの小さなコマンド列
+    std::uint_fast8_t _cmd_len = 0;
 
     void _set_window(std::uint_fast16_t xs, std::uint_fast16_t ys, std::uint_fast16_t xe, std::uint_fast16_t ye);
     bool _check_repeat(std::uint32_t cmd = 0, std::uint_fast8_t limit = 64);
+    void _queue_command(const std::uint8_t* buf, std::size_t len);
+    void _flush_command(void);
+    void _write_encoded(std::uint8_t* dmabuf, std::size_t offset, std::uint32_t length);
   };
 
 //----------------------------------------------------------------------------
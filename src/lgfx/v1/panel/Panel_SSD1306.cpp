@@ -31,6 +31,7 @@ namespace lgfx
   Panel_1bitOLED::~Panel_1bitOLED(void)
   {
     if (_buf) heap_free(_buf);
+    if (_sent) heap_free(_sent);
   }
 
   color_depth_t Panel_1bitOLED::setColorDepth(color_depth_t depth)
@@ -86,6 +87,10 @@ namespace lgfx
     if (_buf) heap_free(_buf);
     _buf = static_cast<std::uint8_t*>(heap_alloc_dma(len));
     memset(_buf, 0, len);
+    if (_sent) heap_free(_sent);
+    _sent = static_cast<std::uint8_t*>(heap_alloc(len));
+    memset(_sent, 0, len);
+    _full_refresh = true;  // the controller RAM content is unknown, the first display() sends everything.
 
     if (!Panel_Device::init(use_reset))
     {
@@ -188,7 +193,9 @@ namespace lgfx
     std::uint32_t ys = y, ye = y + h - 1;
     _update_transferred_rect(xs, ys, xe, ye);
 
-    swap565_t readbuf[w];
+    ScratchArena::checkpoint_t cp(&_scratch);
+    auto readbuf = _scratch.allocate_array<swap565_t>(w);
+    if (readbuf == nullptr) return;
     auto sx = param->src_x32;
     h += y;
     do
@@ -284,7 +291,9 @@ namespace lgfx
 
   void Panel_1bitOLED::readRect(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, void* dst, pixelcopy_t* param)
   {
-    swap565_t readbuf[w];
+    ScratchArena::checkpoint_t cp(&_scratch);
+    auto readbuf = _scratch.allocate_array<swap565_t>(w);
+    if (readbuf == nullptr) return;
     param->src_data = readbuf;
     std::int32_t readpos = 0;
     h += y;
@@ -355,6 +364,23 @@ namespace lgfx
     _range_new.bottom = std::max<std::int32_t>(ye, _range_new.bottom);
   }
 
+  bool Panel_1bitOLED::_diff_span(std::int32_t page, std::int32_t &xs, std::int32_t &xe)
+  {
+    auto a = &_buf[page * _cfg.panel_width];
+    auto b = &_sent[page * _cfg.panel_width];
+    std::int32_t s = xs, e = xe;
+    if (!_full_refresh)
+    {
+      while (s <= e && a[s] == b[s]) { ++s; }
+      if (s > e) { return false; }
+      while (a[e] == b[e]) { --e; }
+    }
+    memcpy(&b[s], &a[s], e - s + 1);
+    xs = s;
+    xe = e;
+    return true;
+  }
+
 //----------------------------------------------------------------------------
 
   void Panel_SSD1306::setBrightness(std::uint8_t brightness)
@@ -377,25 +403,65 @@ namespace lgfx
     }
     if (_range_new.empty()) { return; }
 
-    std::uint_fast8_t xs = _range_new.left;
-    std::uint_fast8_t xe = _range_new.right;
-    _bus->writeCommand(CMD_COLUMNADDR| (xs + _cfg.offset_x) << 8 | (xe + _cfg.offset_x) << 16, 24);
+    std::int32_t xs = _range_new.left;
+    std::int32_t xe = _range_new.right;
+    std::int32_t ys = _range_new.top    >> 3;
+    std::int32_t ye = _range_new.bottom >> 3;
+    _range_new.top    = INT16_MAX;
+    _range_new.left   = INT16_MAX;
+    _range_new.right  = 0;
+    _range_new.bottom = 0;
 
-    std::uint_fast8_t ys = _range_new.top    >> 3;
-    std::uint_fast8_t ye = _range_new.bottom >> 3;
+    // Each page sends only its changed column span. Neighbouring pages share one window
+    // when the extra bytes cost less than setting up another window.
+    static constexpr std::int32_t window_cost = 8;
+    _transfer_bytes = 0;
+    std::int32_t ws = 0, we = 0, wp = 0, wn = 0;
+    for (std::int32_t page = ys; page <= ye + 1; ++page)
+    {
+      std::int32_t s = xs, e = xe;
+      bool changed = page <= ye && _diff_span(page, s, e);
+      if (changed && wn)
+      {
+        std::int32_t us = std::min(ws, s);
+        std::int32_t ue = std::max(we, e);
+        if ((wn + 1) * (ue - us + 1) <= wn * (we - ws + 1) + (e - s + 1) + window_cost)
+        {
+          ws = us;
+          we = ue;
+          ++wn;
+          continue;
+        }
+      }
+      if (wn)
+      {
+        _send_window(ws, we, wp, wp + wn - 1);
+        wn = 0;
+      }
+      if (changed)
+      {
+        ws = s;
+        we = e;
+        wp = page;
+        wn = 1;
+      }
+    }
+    _full_refresh = false;
+  }
+
+  void Panel_SSD1306::_send_window(std::int32_t xs, std::int32_t xe, std::int32_t ys, std::int32_t ye)
+  {
+    _bus->writeCommand(CMD_COLUMNADDR| (xs + _cfg.offset_x) << 8 | (xe + _cfg.offset_x) << 16, 24);
     _bus->writeCommand(CMD_PAGEADDR | (ys + (_cfg.offset_y >> 3)) << 8 | (ye + (_cfg.offset_y >> 3)) << 16, 24);
     _bus->endTransaction();
     _bus->beginTransaction();
+    _transfer_bytes += 6;
     do
     {
       auto buf = &_buf[xs + ys * _cfg.panel_width];
       _bus->writeBytes(buf, xe - xs + 1, true, true);
+      _transfer_bytes += xe - xs + 1;
     } while (++ys <= ye);
-
-    _range_new.top    = INT16_MAX;
-    _range_new.left   = INT16_MAX;
-    _range_new.right  = 0;
-    _range_new.bottom = 0;
   }
 
 //----------------------------------------------------------------------------
@@ -440,31 +506,31 @@ namespace lgfx
     }
     if (_range_new.empty()) { return; }
 
-    std::uint_fast8_t xs = _range_new.left ;
-    std::uint_fast8_t xe = _range_new.right;
-    std::uint_fast8_t ys = _range_new.top    >> 3;
-    std::uint_fast8_t ye = _range_new.bottom >> 3;
+    std::int32_t xs = _range_new.left ;
+    std::int32_t xe = _range_new.right;
+    std::int32_t ys = _range_new.top    >> 3;
+    std::int32_t ye = _range_new.bottom >> 3;
+    _range_new.top    = INT16_MAX;
+    _range_new.left   = INT16_MAX;
+    _range_new.right  = 0;
+    _range_new.bottom = 0;
 
     std::uint_fast8_t offset_y = _cfg.offset_y >> 3;
 
+    // page addressing : each page sends only its changed column span.
+    _transfer_bytes = 0;
     do
     {
-      //_bus->endTransaction();
-      //_bus->beginTransaction();
+      std::int32_t s = xs, e = xe;
+      if (!_diff_span(ys, s, e)) { continue; }
       _bus->writeCommand(  CMD_SETPAGEADDR | (ys + offset_y)
-                        | (CMD_SETHIGHCOLUMN | (xs >> 4)) << 8
-                        | (CMD_SETLOWCOLUMN  | (xs & 0x0F)) << 16
+                        | (CMD_SETHIGHCOLUMN | (s >> 4)) << 8
+                        | (CMD_SETLOWCOLUMN  | (s & 0x0F)) << 16
                         , 24);
-      auto buf = &_buf[xs + ys * _cfg.panel_width];
-      //_bus->endTransaction();
-      //_bus->beginTransaction();
-      _bus->writeBytes(buf, xe - xs + 1, true, true);
+      _bus->writeBytes(&_buf[s + ys * _cfg.panel_width], e - s + 1, true, true);
+      _transfer_bytes += 3 + e - s + 1;
     } while (++ys <= ye);
-
-    _range_new.top    = INT16_MAX;
-    _range_new.left   = INT16_MAX;
-    _range_new.right  = 0;
-    _range_new.bottom = 0;
+    _full_refresh = false;
   }
 
 //----------------------------------------------------------------------------
@@ -59,6 +59,10 @@ namespace lgfx
 
     void readRect(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, void* dst, pixelcopy_t* param) override;
 
+    /// Number of bytes (commands and pixel data) sent to the controller by the last display().
+    /// 直前のdisplay()でコントローラへ送信したバイト数(コマンドと画素データ)
+    std::uint32_t getTransferBytes(void) const { return _transfer_bytes; }
+
   protected:
 
     static constexpr std::uint8_t CMD_SETSTARTLINE        = 0x40;
@@ -73,13 +77,17 @@ namespace lgfx
     static constexpr std::uint8_t CMD_SETVCOMDETECT       = 0xDB;
 
     std::uint8_t* _buf = nullptr;
+    std::uint8_t* _sent = nullptr;  // copy of _buf as last sent to the controller
 
     range_rect_t _range_new;
     std::int32_t _xpos = 0;
     std::int32_t _ypos = 0;
+    std::uint32_t _transfer_bytes = 0;
+    bool _full_refresh = false;
 
     void _draw_pixel(std::int32_t x, std::int32_t y, std::uint32_t value);
     bool _read_pixel(std::int32_t x, std::int32_t y);
+    bool _diff_span(std::int32_t page, std::int32_t &xs, std::int32_t &xe);
     void _update_transferred_rect(std::uint32_t &xs, std::uint32_t &ys, std::uint32_t &xe, std::uint32_t &ye);
 
   };
@@ -115,6 +123,8 @@ namespace lgfx
 
     static constexpr std::uint8_t CMD_DEACTIVATE_SCROLL   = 0x2E;
 
+    void _send_window(std::int32_t xs, std::int32_t xe, std::int32_t ys, std::int32_t ye);
+
     const std::uint8_t* getInitCommands(std::uint8_t listno) const override
     {
       static constexpr std::uint8_t list0[] = {
@@ -126,6 +126,7 @@ namespace lgfx
 
   void Panel_SSD1331::setWindow(std::uint_fast16_t xs, std::uint_fast16_t ys, std::uint_fast16_t xe, std::uint_fast16_t ye)
   {
+    _shadow.setWindow(xs, ys, xe, ye);
     if (_need_delay)
     {
       auto us = lgfx::micros() - _last_us;
@@ -165,6 +166,7 @@ namespace lgfx
 
   void Panel_SSD1331::writeFillRectPreclipped(std::uint_fast16_t x, std::uint_fast16_t y, std::uint_fast16_t w, std::uint_fast16_t h, std::uint32_t rawcolor)
   {
+    _shadow.fill(x, y, w, h, rawcolor);
     auto us = lgfx::micros() - _last_us;
     if (us < _need_delay)
     {
@@ -202,6 +204,7 @@ namespace lgfx
 
   void Panel_SSD1331::copyRect(std::uint_fast16_t dst_x, std::uint_fast16_t dst_y, std::uint_fast16_t w, std::uint_fast16_t h, std::uint_fast16_t src_x, std::uint_fast16_t src_y)
   {
+    _shadow.copyRect(dst_x, dst_y, w, h, src_x, src_y);
     auto us = lgfx::micros() - _last_us;
     if (us < _need_delay)
     {
@@ -74,6 +74,7 @@ namespace lgfx
 
   void Panel_SSD1351::setWindow(std::uint_fast16_t xs, std::uint_fast16_t ys, std::uint_fast16_t xe, std::uint_fast16_t ye)
   {
+    _shadow.setWindow(xs, ys, xe, ye);
     set_window_8(xs, ys, xe, ye, CMD_RAMWR);
   }
 
@@ -84,6 +85,7 @@ namespace lgfx
 
     set_window_8(x, y, x, y, CMD_RAMWR);
     _bus->writeData(rawcolor, _write_bits);
+    _shadow.fill(x, y, 1, 1, rawcolor);
 
     if (!tr) end_transaction();
   }
@@ -95,6 +97,7 @@ namespace lgfx
     std::uint_fast16_t ye = y + h - 1;
     set_window_8(x, y, xe, ye, CMD_RAMWR);
     _bus->writeDataRepeat(rawcolor, _write_bits, len);
+    _shadow.fill(x, y, w, h, rawcolor);
   }
 
   void Panel_SSD1351::set_window_8(std::uint_fast16_t xs, std::uint_fast16_t ys, std::uint_fast16_t xe, std::uint_fast16_t ye, std::uint32_t cmd)
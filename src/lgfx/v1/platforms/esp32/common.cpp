@@ -22,6 +22,7 @@ Contributors:
 #include <algorithm>
 #include <cstring>
 
+#include <freertos/semphr.h>
 #include <driver/i2c.h>
 #include <driver/spi_common.h>
 #include <driver/rtc_io.h>
@@ -103,6 +104,168 @@ namespace lgfx
 #endif
   }
 
+//----------------------------------------------------------------------------
+
+  struct sampling_task_t
+  {
+    bool (*fn)(void*);
+    void* arg;
+    TaskHandle_t handle;
+    std::uint32_t interval_ms;
+    std::int16_t pin_int;
+    volatile bool running;
+    volatile bool finished;
+  };
+
+  static void IRAM_ATTR sampling_isr(void* arg)
+  {
+    auto st = (sampling_task_t*)arg;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(st->handle, &woken);
+    if (woken) { portYIELD_FROM_ISR(); }
+  }
+
+  static void sampling_task(void* arg)
+  {
+    auto st = (sampling_task_t*)arg;
+    bool active = true;
+    while (st->running)
+    {
+      TickType_t wait = (active || st->pin_int < 0)
+                      ? std::max<TickType_t>(1, st->interval_ms / portTICK_PERIOD_MS)
+                      : portMAX_DELAY;
+      ulTaskNotifyTake(pdTRUE, wait);
+      if (!st->running) break;
+      active = st->fn(st->arg);
+    }
+    st->finished = true;
+    vTaskDelete(nullptr);
+  }
+
+  void* startSamplingTask(bool (*fn)(void*), void* arg, std::int_fast16_t pin_int, std::uint32_t interval_ms, std::int_fast8_t core)
+  {
+    if (fn == nullptr) return nullptr;
+    auto st = (sampling_task_t*)heap_alloc(sizeof(sampling_task_t));
+    if (st == nullptr) return nullptr;
+    st->fn = fn;
+    st->arg = arg;
+    st->handle = nullptr;
+    st->interval_ms = interval_ms;
+    st->pin_int = pin_int;
+    st->running = true;
+    st->finished = false;
+
+    if (pdPASS != xTaskCreatePinnedToCore(sampling_task, "lgfx_sampling", 2048, st, 1, &st->handle, core < 0 ? tskNO_AFFINITY : core))
+    {
+      heap_free(st);
+      return nullptr;
+    }
+
+    if (pin_int >= 0)
+    {
+      gpio_install_isr_service(0);  // already installed is not an error here.
+      gpio_set_intr_type((gpio_num_t)pin_int, GPIO_INTR_NEGEDGE);
+      if (ESP_OK != gpio_isr_handler_add((gpio_num_t)pin_int, sampling_isr, st))
+      { /// ISR unavailable, fall back to periodic polling.
+        st->pin_int = -1;
+      }
+    }
+    return st;
+  }
+
+  void stopSamplingTask(void* task)
+  {
+    auto st = (sampling_task_t*)task;
+    if (st == nullptr) return;
+    if (st->pin_int >= 0)
+    {
+      gpio_isr_handler_remove((gpio_num_t)st->pin_int);
+      gpio_set_intr_type((gpio_num_t)st->pin_int, GPIO_INTR_DISABLE);
+    }
+    st->running = false;
+    xTaskNotifyGive(st->handle);
+    while (!st->finished) { vTaskDelay(1); }
+    heap_free(st);
+  }
+
+//----------------------------------------------------------------------------
+
+  struct worker_task_t
+  {
+    void (*fn)(void*);
+    void* arg;
+    TaskHandle_t handle;
+    SemaphoreHandle_t done;
+    volatile bool running;
+    volatile bool finished;
+  };
+
+  static void worker_task(void* arg)
+  {
+    auto wt = (worker_task_t*)arg;
+    for (;;)
+    {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      if (!wt->running) break;
+      wt->fn(wt->arg);
+      xSemaphoreGive(wt->done);
+    }
+    wt->finished = true;
+    vTaskDelete(nullptr);
+  }
+
+  void* startWorkerTask(std::int_fast8_t core)
+  {
+    auto wt = (worker_task_t*)heap_alloc(sizeof(worker_task_t));
+    if (wt == nullptr) return nullptr;
+    wt->fn = nullptr;
+    wt->arg = nullptr;
+    wt->handle = nullptr;
+    wt->running = true;
+    wt->finished = false;
+    wt->done = xSemaphoreCreateBinary();
+    if (wt->done == nullptr)
+    {
+      heap_free(wt);
+      return nullptr;
+    }
+    if (pdPASS != xTaskCreatePinnedToCore(worker_task, "lgfx_worker", 2048, wt, uxTaskPriorityGet(nullptr), &wt->handle, core < 0 ? tskNO_AFFINITY : core))
+    {
+      vSemaphoreDelete(wt->done);
+      heap_free(wt);
+      return nullptr;
+    }
+    return wt;
+  }
+
+  bool runWorkerTask(void* task, void (*fn)(void*), void* arg)
+  {
+    auto wt = (worker_task_t*)task;
+    if (wt == nullptr) return false;
+    wt->fn = fn;
+    wt->arg = arg;
+    xTaskNotifyGive(wt->handle);
+    return true;
+  }
+
+  void waitWorkerTask(void* task)
+  {
+    auto wt = (worker_task_t*)task;
+    if (wt == nullptr) return;
+    xSemaphoreTake(wt->done, portMAX_DELAY);
+  }
+
+  void stopWorkerTask(void* task)
+  {
+    auto wt = (worker_task_t*)task;
+    if (wt == nullptr) return;
+    wt->running = false;
+    xTaskNotifyGive(wt->handle);
+    while (!wt->finished) { vTaskDelay(1); }
+    vSemaphoreDelete(wt->done);
+    heap_free(wt);
+  }
+
 //----------------------------------------------------------------------------
 
   namespace spi
@@ -334,6 +497,8 @@ namespace lgfx
       gpio_num_t pin_scl = (gpio_num_t)-1;
       gpio_num_t pin_sda = (gpio_num_t)-1;
       std::uint32_t freq = 0;
+      SemaphoreHandle_t lock = nullptr;  // recursive, created by init()
+      StaticSemaphore_t lock_buf;
 
       void save_reg(i2c_dev_t* dev)
       {
@@ -383,6 +548,19 @@ namespace lgfx
     };
     i2c_context_t i2c_context[I2C_NUM_MAX];
 
+    /// A transaction holds the lock of its port from beginTransaction to endTransaction,
+    /// so other tasks (e.g. the touch sampling task) cannot interleave on the same controller.
+    /// トランザクション中はポートのロックを保持し、他タスクの割込みを防ぐ
+    static void i2c_lock(int i2c_port)
+    {
+      if (auto lock = i2c_context[i2c_port].lock) { xSemaphoreTakeRecursive(lock, portMAX_DELAY); }
+    }
+
+    static void i2c_unlock(int i2c_port)
+    {
+      if (auto lock = i2c_context[i2c_port].lock) { xSemaphoreGiveRecursive(lock); }
+    }
+
     static void i2c_set_cmd(i2c_dev_t* dev, uint8_t index, uint8_t op_code, uint8_t byte_num)
     {
       typeof(dev->command[0]) cmd;
@@ -486,6 +664,11 @@ namespace lgfx
     cpp::result<void, error_t> init(int i2c_port, int pin_sda, int pin_scl)
     {
       if (i2c_port >= I2C_NUM_MAX) { return cpp::fail(error_t::invalid_arg); }
+      if (i2c_context[i2c_port].lock == nullptr)
+      {
+        i2c_context[i2c_port].lock = xSemaphoreCreateRecursiveMutexStatic(&i2c_context[i2c_port].lock_buf);
+      }
+      i2c_lock(i2c_port);
       auto dev = (i2c_port == 0) ? &I2C0 : &I2C1;
       i2c_context[i2c_port].save_reg(dev);
       release(i2c_port);
@@ -493,6 +676,7 @@ namespace lgfx
       i2c_context[i2c_port].pin_sda = (gpio_num_t)pin_sda;
       i2c_stop(i2c_port);
       i2c_context[i2c_port].load_reg(dev);
+      i2c_unlock(i2c_port);
 
       return {};
     }
@@ -501,6 +685,7 @@ namespace lgfx
     {
       if (i2c_port >= I2C_NUM_MAX) { return cpp::fail(error_t::invalid_arg); }
 
+      i2c_lock(i2c_port);
       if (i2c_context[i2c_port].pin_scl >= 0 || i2c_context[i2c_port].pin_sda >= 0)
       {
         periph_module_disable(i2c_port == 0 ? PERIPH_I2C0_MODULE : PERIPH_I2C1_MODULE);
@@ -509,6 +694,7 @@ namespace lgfx
         i2c_context[i2c_port].pin_scl = (gpio_num_t)-1;
         i2c_context[i2c_port].pin_sda = (gpio_num_t)-1;
       }
+      i2c_unlock(i2c_port);
 
       return {};
     }
@@ -612,6 +798,7 @@ namespace lgfx
 
 //ESP_LOGI("LGFX", "i2c::beginTransaction : port:%d / addr:%02x / freq:%d / rw:%d", i2c_port, i2c_addr, freq, read);
 
+      i2c_lock(i2c_port);  // released by endTransaction, even when this fails.
       auto dev = (i2c_port == 0) ? &I2C0 : &I2C1;
       i2c_context[i2c_port].save_reg(dev);
 
@@ -652,7 +839,9 @@ namespace lgfx
     cpp::result<void, error_t> endTransaction(int i2c_port)
     {
       if (i2c_port >= I2C_NUM_MAX) return cpp::fail(error_t::invalid_arg);
-      return i2c_wait(i2c_port, true);
+      auto res = i2c_wait(i2c_port, true);
+      i2c_unlock(i2c_port);
+      return res;
     }
 //*/
     cpp::result<void, error_t> writeBytes(int i2c_port, const std::uint8_t *data, std::size_t length)
@@ -748,8 +937,9 @@ namespace lgfx
        && (res = writeBytes(i2c_port, writedata, writelen)).has_value()
       )
       {
-        res = endTransaction(i2c_port);
+        return endTransaction(i2c_port);
       }
+      endTransaction(i2c_port);
       return res;
     }
 
@@ -760,8 +950,9 @@ namespace lgfx
        && (res = readBytes(i2c_port, readdata, readlen)).has_value()
       )
       {
-        res = endTransaction(i2c_port);
+        return endTransaction(i2c_port);
       }
+      endTransaction(i2c_port);
       return res;
     }
 
@@ -774,8 +965,9 @@ namespace lgfx
        && (res = readBytes(i2c_port, readdata, readlen)).has_value()
       )
       {
-        res = endTransaction(i2c_port);
+        return endTransaction(i2c_port);
       }
+      endTransaction(i2c_port);
       return res;
     }
 
@@ -788,14 +980,18 @@ namespace lgfx
 
     cpp::result<void, error_t> registerWrite8(int i2c_port, int addr, std::uint8_t reg, std::uint8_t data, std::uint8_t mask, std::uint32_t freq)
     {
+      if (i2c_port >= I2C_NUM_MAX) { return cpp::fail(error_t::invalid_arg); }
       std::uint8_t tmp[2] = { reg, data };
+      i2c_lock(i2c_port);  // keep the read-modify-write in one piece.
       if (mask)
       {
         auto res = transactionWriteRead(i2c_port, addr, &reg, 1, &tmp[1], 1, freq);
-        if (res.has_error()) { return res; }
+        if (res.has_error()) { i2c_unlock(i2c_port); return res; }
         tmp[1] = (tmp[1] & mask) | data;
       }
-      return transactionWrite(i2c_port, addr, tmp, 2, freq);
+      auto res = transactionWrite(i2c_port, addr, tmp, 2, freq);
+      i2c_unlock(i2c_port);
+      return res;
     }
 
   }
@@ -26,6 +26,7 @@ Contributors:
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <driver/gpio.h>
+#include <soc/soc_memory_layout.h>
 
 namespace lgfx
 {
@@ -55,6 +56,7 @@ namespace lgfx
   static inline void* heap_alloc_dma(  size_t length) { return heap_caps_malloc((length + 3) & ~3, MALLOC_CAP_DMA);  }
   static inline void* heap_alloc_psram(size_t length) { return heap_caps_malloc(length, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);  }
   static inline void heap_free(void* buf) { heap_caps_free(buf); }
+  static inline bool heap_capable_dma(const void* ptr) { return esp_ptr_dma_capable(ptr); }
 
   enum pin_mode_t
   { output
@@ -80,6 +82,23 @@ namespace lgfx
   std::uint32_t getApbFrequency(void);
   std::uint32_t FreqToClockDiv(std::uint32_t fapb, std::uint32_t hz);
 
+  /// Call fn(arg) on a background task every interval_ms.
+  /// If pin_int is specified, the task sleeps while fn returns false and wakes up at the falling edge of the pin.
+  /// バックグラウンドタスクで fn(arg) を interval_ms 毎に呼び出す。
+  /// pin_int を指定した場合、fn が false を返している間はピンの立下りまでタスクを休止する。
+  void* startSamplingTask(bool (*fn)(void*), void* arg, std::int_fast16_t pin_int, std::uint32_t interval_ms, std::int_fast8_t core = -1);
+  void stopSamplingTask(void* task);
+
+  /// Create a task waiting for jobs, pinned to core (-1 : no affinity). It runs at the priority of the caller.
+  /// ジョブを待機するタスクを生成する。coreで実行コアを指定(-1:指定なし)。優先度は呼出し元と同じ
+  void* startWorkerTask(std::int_fast8_t core = -1);
+  /// Call fn(arg) on the worker task. Returns false when the job was not started (task is nullptr).
+  /// ワーカータスク上で fn(arg) を呼び出す。開始できなかった場合(taskがnullptr)はfalseを返す
+  bool runWorkerTask(void* task, void (*fn)(void*), void* arg);
+  /// Wait for the end of the job started by runWorkerTask.
+  void waitWorkerTask(void* task);
+  void stopWorkerTask(void* task);
+
 //----------------------------------------------------------------------------
 
 #if defined (ARDUINO)
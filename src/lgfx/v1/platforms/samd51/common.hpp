@@ -136,6 +136,7 @@ namespace lgfx
   static inline void* heap_alloc_psram(size_t length) { return malloc(length); }
   static inline void* heap_alloc_dma(  size_t length) { return memalign(16, length); }
   static inline void heap_free(void* buf) { free(buf); }
+  static inline bool heap_capable_dma(const void*) { return true; }
 
   static inline void gpio_hi(std::uint32_t pin) {        PORT->Group[pin >> samd51::PORT_SHIFT].OUTSET.reg = (1ul << (pin & samd51::PIN_MASK)); }
   static inline void gpio_lo(std::uint32_t pin) {        PORT->Group[pin >> samd51::PORT_SHIFT].OUTCLR.reg = (1ul << (pin & samd51::PIN_MASK)); }
@@ -154,6 +155,16 @@ namespace lgfx
     pinMode(pin, mode);
   }
 
+  /// unimplemented.
+  static inline void* startSamplingTask(bool (*)(void*), void*, std::int_fast16_t, std::uint32_t, std::int_fast8_t = -1) { return nullptr; }
+  static inline void stopSamplingTask(void*) {}
+
+  /// unimplemented, runWorkerTask returns false and the caller runs the job itself.
+  static inline void* startWorkerTask(std::int_fast8_t = -1) { return nullptr; }
+  static inline bool runWorkerTask(void*, void (*)(void*), void*) { return false; }
+  static inline void waitWorkerTask(void*) {}
+  static inline void stopWorkerTask(void*) {}
+
 //----------------------------------------------------------------------------
   struct FileWrapper : public DataWrapper
   {
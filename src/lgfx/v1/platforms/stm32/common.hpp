@@ -73,6 +73,7 @@ namespace lgfx
   static inline void* heap_alloc_psram(size_t length) { return malloc(length); }
   static inline void* heap_alloc_dma(  size_t length) { return memalign(16, length); }
   static inline void heap_free(void* buf) { free(buf); }
+  static inline bool heap_capable_dma(const void*) { return true; }
 
   static inline volatile std::uint32_t* get_gpio_out_reg(std::int_fast8_t pin)
   {
@@ -103,6 +104,16 @@ namespace lgfx
     pinMode(pin, mode);
   }
 
+  /// unimplemented.
+  static inline void* startSamplingTask(bool (*)(void*), void*, std::int_fast16_t, std::uint32_t, std::int_fast8_t = -1) { return nullptr; }
+  static inline void stopSamplingTask(void*) {}
+
+  /// unimplemented, runWorkerTask returns false and the caller runs the job itself.
+  static inline void* startWorkerTask(std::int_fast8_t = -1) { return nullptr; }
+  static inline bool runWorkerTask(void*, void (*)(void*), void*) { return false; }
+  static inline void waitWorkerTask(void*) {}
+  static inline void stopWorkerTask(void*) {}
+
 //----------------------------------------------------------------------------
   struct FileWrapper : public DataWrapper
   {